@@ -0,0 +1,61 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <memory>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "credential.hpp"
+#include "session_tokens.hpp"
+
+namespace {
+    constexpr std::string_view password = "benchmark-password";
+
+    auto get_credential() -> const fox::Credential& {
+        static const auto credential = [] {
+            auto credential = std::make_unique<fox::Credential>();
+            credential->set(password);
+            return credential;
+        }();
+
+        return *credential;
+    }
+
+    auto bench_password_match(benchmark::State& state) -> void {
+        const auto& credential = get_credential();
+
+        // Every other attempt is wrong, both have to cost the same
+        bool is_correct = state.thread_index() % 2 == 0;
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(credential.matches(is_correct ? password : std::string_view("benchmark-passwort")));
+            is_correct = !is_correct;
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    auto bench_token_verify(benchmark::State& state) -> void {
+        static fox::SessionTokens tokens(std::chrono::minutes(15));
+        const auto token = tokens.issue();
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(tokens.verify(token));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    auto bench_token_issue(benchmark::State& state) -> void {
+        fox::SessionTokens tokens(std::chrono::minutes(15));
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(tokens.issue());
+        }
+    }
+}
+
+BENCHMARK(bench_password_match)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_token_verify)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_token_issue);
\ No newline at end of file
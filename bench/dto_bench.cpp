@@ -0,0 +1,83 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <string>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include "dto.hpp"
+#include "json_writer.hpp"
+
+namespace {
+    auto make_task() noexcept -> fox::dto::Task {
+        fox::dto::Task task{};
+        static_cast<void>(task.set_value(fox::dto::TaskType::SPEED, 42));
+        return task;
+    }
+
+    auto bench_task_serialize(benchmark::State& state) -> void {
+        const auto task = make_task();
+
+        for (auto _: state) {
+            auto json = nlohmann::json::object();
+            task.serialize(json);
+            benchmark::DoNotOptimize(json);
+        }
+    }
+
+    auto bench_task_deserialize(benchmark::State& state) -> void {
+        auto json = nlohmann::json::object();
+        make_task().serialize(json);
+
+        for (auto _: state) {
+            fox::dto::Task task{};
+            task.deserialize(json);
+            benchmark::DoNotOptimize(task);
+        }
+    }
+
+    auto bench_task_write(benchmark::State& state) -> void {
+        const auto task = make_task();
+        fmt::memory_buffer buffer;
+
+        for (auto _: state) {
+            buffer.clear();
+            fox::JsonWriter writer(buffer);
+            writer.write_object(task);
+            benchmark::DoNotOptimize(buffer.data());
+        }
+    }
+
+    auto bench_task_pack_unpack(benchmark::State& state) -> void {
+        const auto task = make_task();
+        std::string packed;
+
+        for (auto _: state) {
+            packed.clear();
+            task.pack(packed);
+            fox::dto::Task unpacked{};
+            benchmark::DoNotOptimize(unpacked.unpack(packed.data()));
+        }
+    }
+
+    auto bench_state_write(benchmark::State& state) -> void {
+        fox::dto::DeviceState device_state{};
+        fmt::memory_buffer buffer;
+
+        for (auto _: state) {
+            buffer.clear();
+            fox::JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.write_fields(device_state);
+            writer.end_object();
+            benchmark::DoNotOptimize(buffer.data());
+        }
+    }
+}
+
+BENCHMARK(bench_task_serialize);
+BENCHMARK(bench_task_deserialize);
+BENCHMARK(bench_task_write);
+BENCHMARK(bench_task_pack_unpack);
+BENCHMARK(bench_state_write);
\ No newline at end of file
@@ -0,0 +1,83 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include "enqueue_parser.hpp"
+
+namespace {
+    auto make_enqueue_body(kstd::usize task_count) -> std::string {
+        auto tasks = nlohmann::json::array();
+
+        for (kstd::usize i = 0; i < task_count; ++i) {
+            auto task = nlohmann::json::object();
+
+            switch (i % 3) {
+                case 0:
+                    task["type"] = fox::dto::TaskType::POWER;
+                    task["is_on"] = true;
+                    break;
+                case 1:
+                    task["type"] = fox::dto::TaskType::SPEED;
+                    task["speed"] = static_cast<kstd::i32>(i % 100);
+                    break;
+                default:
+                    task["type"] = fox::dto::TaskType::MODE;
+                    task["mode"] = fox::dto::Mode::DEFAULT;
+                    break;
+            }
+
+            tasks.push_back(task);
+        }
+
+        auto body = nlohmann::json::object();
+        body["password"] = "benchmark-password";
+        body["tasks"] = tasks;
+        return body.dump();
+    }
+
+    // What /enqueue used to do, parse into a DOM and deserialize task by task
+    auto bench_enqueue_parse_dom(benchmark::State& state) -> void {
+        const auto body = make_enqueue_body(static_cast<kstd::usize>(state.range(0)));
+        std::vector<fox::dto::Task> tasks;
+
+        for (auto _: state) {
+            tasks.clear();
+            const auto req_body = nlohmann::json::parse(body);
+            auto password = static_cast<std::string>(req_body["password"]);
+            benchmark::DoNotOptimize(password);
+
+            for (const auto& task: req_body["tasks"]) {
+                fox::dto::Task task_dto{};
+                task_dto.deserialize(task);
+                tasks.push_back(task_dto);
+            }
+
+            benchmark::DoNotOptimize(tasks.data());
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(static_cast<kstd::i64>(state.iterations() * body.size()));
+    }
+
+    auto bench_enqueue_parse_sax(benchmark::State& state) -> void {
+        const auto body = make_enqueue_body(static_cast<kstd::usize>(state.range(0)));
+        fox::EnqueueParser parser;
+
+        for (auto _: state) {
+            const auto result = parser.parse(body, nlohmann::json::input_format_t::json);
+            benchmark::DoNotOptimize(result);
+            benchmark::DoNotOptimize(parser.get_tasks().data());
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(static_cast<kstd::i64>(state.iterations() * body.size()));
+    }
+}
+
+BENCHMARK(bench_enqueue_parse_dom)->Arg(1)->Arg(100)->Arg(10000);
+BENCHMARK(bench_enqueue_parse_sax)->Arg(1)->Arg(100)->Arg(10000);
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include "gateway.hpp"
+
+namespace {
+    constexpr std::string_view password = "benchmark-password";
+
+    // Started once and shared by every run, on any free port so it never clashes with a running gateway
+    auto get_gateway() -> fox::Gateway& {
+        static auto gateway = [] {
+            auto gateway = std::make_unique<fox::Gateway>(fox::GatewayConfig{
+                "127.0.0.1", 0, 8, 4096, fox::QueueConfig{}, 16, 4, 64, 32, 0, 64, 900, "", "", std::string(password)
+            });
+
+            if (!gateway->start()) {
+                std::abort();
+            }
+
+            return gateway;
+        }();
+
+        return *gateway;
+    }
+
+    // Full HTTP round-trip of a controller poll on an empty queue, over a keep-alive connection per thread
+    auto bench_fetch_roundtrip(benchmark::State& state) -> void {
+        auto& gateway = get_gateway();
+        httplib::Client client("127.0.0.1", static_cast<kstd::i32>(gateway.get_port()));
+        client.set_keep_alive(true);
+
+        auto body = nlohmann::json::object();
+        body["password"] = password;
+        const auto req_body = body.dump();
+
+        for (auto _: state) {
+            const auto res = client.Post("/fetch", req_body, FOX_JSON_MIME_TYPE);
+
+            if (!res || res->status != 200) {
+                state.SkipWithError("Request failed");
+                break;
+            }
+
+            benchmark::DoNotOptimize(res->body.data());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // A whole controller cycle, reporting the actual speed and polling the queue, in a single request
+    auto bench_sync_roundtrip(benchmark::State& state) -> void {
+        auto& gateway = get_gateway();
+        httplib::Client client("127.0.0.1", static_cast<kstd::i32>(gateway.get_port()));
+        client.set_keep_alive(true);
+        const auto path = fmt::format("/sync?device=bench-{}", state.thread_index());
+        kstd::u32 speed = 0;
+
+        for (auto _: state) {
+            auto body = nlohmann::json::object();
+            body["password"] = password;
+            body["state"]["actual_speed"] = ++speed;
+            const auto res = client.Post(path, body.dump(), FOX_JSON_MIME_TYPE);
+
+            if (!res || res->status != 200) {
+                state.SkipWithError("Request failed");
+                break;
+            }
+
+            benchmark::DoNotOptimize(res->body.data());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(bench_fetch_roundtrip)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(bench_sync_roundtrip)->ThreadRange(1, 8)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,96 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "device.hpp"
+#include "json_writer.hpp"
+
+namespace {
+    auto make_config(kstd::u32 backlog, fox::ResidenceTracker* residence_tracker) -> fox::DeviceConfig {
+        return {backlog, fox::QueueConfig{}, 64, 32, std::chrono::minutes(15), {}, nullptr, {}, residence_tracker};
+    }
+
+    auto make_task(kstd::usize index) noexcept -> fox::dto::Task {
+        fox::dto::Task task{};
+        static_cast<void>(task.set_value(static_cast<fox::dto::TaskType>(index % fox::dto::task_type_count), static_cast<kstd::u32>(index)));
+        return task;
+    }
+
+    // Shared by every thread of a run, so they all contend on the same queue
+    auto get_shared_device() -> fox::Device& {
+        static fox::ResidenceTracker residence_tracker;
+        static fox::Device device("bench", make_config(65536, &residence_tracker));
+        return device;
+    }
+
+    auto bench_enqueue_dequeue(benchmark::State& state) -> void {
+        auto& device = get_shared_device();
+        auto index = static_cast<kstd::usize>(state.thread_index());
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(device.enqueue_task(make_task(index++)));
+            benchmark::DoNotOptimize(device.dequeue_task());
+        }
+
+        if (state.thread_index() == 0) {
+            state.counters["queued"] = static_cast<double>(device.get_task_count());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // The queue on its own, without the device bookkeeping around it
+    auto bench_queue_push_pop(benchmark::State& state) -> void {
+        static fox::TaskQueue queue(65536, fox::QueueConfig{});
+        auto index = static_cast<kstd::usize>(state.thread_index());
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(queue.try_push(make_task(index++)));
+            benchmark::DoNotOptimize(queue.try_pop());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // What /fetch does for a JSON response, at the given queue depth
+    auto bench_fetch(benchmark::State& state) -> void {
+        const auto depth = static_cast<kstd::usize>(state.range(0));
+        fox::ResidenceTracker residence_tracker;
+        fox::Device device("bench", make_config(static_cast<kstd::u32>(depth), &residence_tracker));
+        fmt::memory_buffer buffer;
+
+        for (auto _: state) {
+            state.PauseTiming();
+
+            for (kstd::usize i = 0; i < depth; ++i) {
+                static_cast<void>(device.enqueue_task(make_task(i)));
+            }
+
+            state.ResumeTiming();
+
+            buffer.clear();
+            fox::JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.write_key("tasks");
+            writer.begin_array();
+
+            for (const auto& task: device.dequeue_buffered(depth)) {
+                writer.write_object(task);
+            }
+
+            writer.end_array();
+            writer.write_field("timestamp", kstd::u64{0});
+            writer.end_object();
+            benchmark::DoNotOptimize(buffer.data());
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(bench_enqueue_dequeue)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_queue_push_pop)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_fetch)->Arg(1)->Arg(16)->Arg(256)->Arg(4096);
\ No newline at end of file
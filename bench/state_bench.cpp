@@ -0,0 +1,146 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <shared_mutex>
+#include <benchmark/benchmark.h>
+#include "device.hpp"
+#include "json_writer.hpp"
+
+namespace {
+    // What Device used to do, a reader-writer lock around the state
+    class LockedState final {
+        fox::dto::DeviceState _state{};
+        mutable std::shared_mutex _mutex;
+
+        public:
+
+        [[nodiscard]] inline auto get() const noexcept -> fox::dto::DeviceState {
+            const std::shared_lock lock(_mutex);
+            return _state;
+        }
+
+        inline auto set(const fox::dto::DeviceState& state) noexcept -> void {
+            const std::unique_lock lock(_mutex);
+            _state = state;
+        }
+    };
+
+    auto make_state(kstd::u32 speed) noexcept -> fox::dto::DeviceState {
+        return {true, true, speed, speed, fox::dto::Mode::DEFAULT};
+    }
+
+    auto get_device() -> fox::Device& {
+        static fox::Device device("bench", {64, fox::QueueConfig{}, 64, 32, std::chrono::minutes(15), {}, nullptr, {}, nullptr});
+        return device;
+    }
+
+    // Every thread polls, like dashboards hammering /getstate
+    auto bench_state_read_locked(benchmark::State& state) -> void {
+        static LockedState locked_state;
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(locked_state.get());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    auto bench_state_read_seqlock(benchmark::State& state) -> void {
+        auto& device = get_device();
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(device.get_state());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // The first thread plays the controller reporting its speed, all others poll
+    auto bench_state_mixed_locked(benchmark::State& state) -> void {
+        static LockedState locked_state;
+        kstd::u32 speed = 0;
+
+        for (auto _: state) {
+            if (state.thread_index() == 0) {
+                locked_state.set(make_state(++speed));
+            }
+            else {
+                benchmark::DoNotOptimize(locked_state.get());
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    auto bench_state_mixed_seqlock(benchmark::State& state) -> void {
+        auto& device = get_device();
+        kstd::u32 speed = 0;
+
+        for (auto _: state) {
+            if (state.thread_index() == 0) {
+                device.set_state(make_state(++speed));
+            }
+            else {
+                benchmark::DoNotOptimize(device.get_state());
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // What /getstate used to do, serialize the state for every poll
+    auto bench_getstate_body_rebuild(benchmark::State& state) -> void {
+        auto& device = get_device();
+        fmt::memory_buffer buffer;
+
+        for (auto _: state) {
+            buffer.clear();
+            const auto versioned_state = device.get_versioned_state();
+            fox::JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.write_fields(versioned_state.state);
+            writer.write_field("device", std::string_view(device.get_id()));
+            writer.write_field("is_online", versioned_state.is_online);
+            writer.write_field("timestamp", static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+            writer.end_object();
+            benchmark::DoNotOptimize(std::string(buffer.data(), buffer.size()));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    auto bench_getstate_body_cached(benchmark::State& state) -> void {
+        auto& device = get_device();
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(device.serialize_state());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // A reader one report behind, where the controller only changed its actual speed
+    auto bench_getstate_delta(benchmark::State& state) -> void {
+        static fox::Device device("bench-delta", {64, fox::QueueConfig{}, 64, 32, std::chrono::minutes(15), {}, nullptr, {}, nullptr});
+        device.set_state(make_state(1));
+        const auto since_version = device.get_versioned_state().version;
+        device.set_state({true, true, 1, 2, fox::dto::Mode::DEFAULT});
+        const auto versioned_state = device.get_versioned_state();
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(device.serialize_delta(versioned_state, since_version));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(bench_state_read_locked)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_state_read_seqlock)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_state_mixed_locked)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK(bench_state_mixed_seqlock)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK(bench_getstate_body_rebuild)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_getstate_body_cached)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(bench_getstate_delta);
\ No newline at end of file
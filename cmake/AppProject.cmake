@@ -3,6 +3,12 @@ include(TemplateProject)
 set(APP_INCLUDE_DIR ${CMAKE_SOURCE_DIR}/include)
 file(GLOB_RECURSE APP_SOURCE_FILES ${CMAKE_SOURCE_DIR}/src/*.cpp)
 file(GLOB_RECURSE APP_TEST_SOURCES ${CMAKE_SOURCE_DIR}/test/*.cpp)
+file(GLOB_RECURSE APP_BENCH_SOURCES ${CMAKE_SOURCE_DIR}/bench/*.cpp)
+file(GLOB_RECURSE APP_LOADGEN_SOURCES ${CMAKE_SOURCE_DIR}/loadgen/*.cpp)
+
+# The static library is linked into other executables, so it must not bring its own entry point
+set(APP_LIBRARY_SOURCE_FILES ${APP_SOURCE_FILES})
+list(FILTER APP_LIBRARY_SOURCE_FILES EXCLUDE REGEX ".*/src/main\\.cpp$")
 
 # Macros
 macro(app_define_binary_target)
@@ -20,7 +26,7 @@ endmacro()
 macro(app_define_static_target)
     set(APP_STATIC_TARGET "${CMAKE_PROJECT_NAME}_static")
     # Static library (for tests)
-    add_library("${CMAKE_PROJECT_NAME}_static" STATIC ${APP_SOURCE_FILES})
+    add_library("${CMAKE_PROJECT_NAME}_static" STATIC ${APP_LIBRARY_SOURCE_FILES})
     target_include_directories("${CMAKE_PROJECT_NAME}_static" PUBLIC ${APP_INCLUDE_DIR})
 
     if (PLATFORM_WINDOWS)
@@ -33,11 +39,36 @@ macro(app_define_test_target)
     # Tests
     add_executable("${CMAKE_PROJECT_NAME}_test" ${APP_TEST_SOURCES})
     target_include_gtest("${CMAKE_PROJECT_NAME}_test")
-    target_include_directories("${CMAKE_PROJECT_NAME}_test" PUBLIC ${APP_INCLUDE_DIR})
+    target_include_directories("${CMAKE_PROJECT_NAME}_test" PUBLIC ${APP_INCLUDE_DIR} ${CMAKE_SOURCE_DIR}/src)
     target_link_libraries("${CMAKE_PROJECT_NAME}_test" "${CMAKE_PROJECT_NAME}_static")
     add_dependencies("${CMAKE_PROJECT_NAME}_test" "${CMAKE_PROJECT_NAME}_static")
 endmacro()
 
+macro(app_define_bench_target)
+    set(APP_BENCH_TARGET "${CMAKE_PROJECT_NAME}_bench")
+    # Benchmarks
+    add_executable("${CMAKE_PROJECT_NAME}_bench" ${APP_BENCH_SOURCES})
+    target_include_benchmark("${CMAKE_PROJECT_NAME}_bench")
+    target_include_directories("${CMAKE_PROJECT_NAME}_bench" PUBLIC ${APP_INCLUDE_DIR} ${CMAKE_SOURCE_DIR}/src)
+    target_link_libraries("${CMAKE_PROJECT_NAME}_bench" "${CMAKE_PROJECT_NAME}_static")
+    add_dependencies("${CMAKE_PROJECT_NAME}_bench" "${CMAKE_PROJECT_NAME}_static")
+    # Machine readable results, so runs of different releases can be compared
+    add_custom_target("${CMAKE_PROJECT_NAME}_bench_json"
+            COMMAND "${CMAKE_PROJECT_NAME}_bench" --benchmark_format=console --benchmark_out_format=json
+                "--benchmark_out=${CMAKE_BINARY_DIR}/${CMAKE_PROJECT_NAME}_bench.json"
+            DEPENDS "${CMAKE_PROJECT_NAME}_bench"
+            USES_TERMINAL)
+endmacro()
+
+macro(app_define_loadgen_target)
+    set(APP_LOADGEN_TARGET "fox-control-loadgen")
+    # HTTP load generator
+    add_executable("fox-control-loadgen" ${APP_LOADGEN_SOURCES})
+    target_include_directories("fox-control-loadgen" PUBLIC ${APP_INCLUDE_DIR} ${CMAKE_SOURCE_DIR}/src)
+    target_link_libraries("fox-control-loadgen" "${CMAKE_PROJECT_NAME}_static")
+    add_dependencies("fox-control-loadgen" "${CMAKE_PROJECT_NAME}_static")
+endmacro()
+
 macro(app_define_targets)
     app_define_binary_target()
     app_define_static_target()
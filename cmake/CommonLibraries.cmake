@@ -153,6 +153,25 @@ macro(target_include_gtest target)
     target_link_libraries(${target} gtest_main)
 endmacro()
 
+# Google Benchmark
+set(CL_BENCHMARK_VERSION 1.8.3)
+set(CL_BENCHMARK_FETCHED OFF)
+
+macro(target_include_benchmark target)
+    if (NOT CL_BENCHMARK_FETCHED)
+        FetchContent_Declare(
+                benchmark
+                GIT_REPOSITORY https://github.com/google/benchmark.git
+                GIT_TAG "v${CL_BENCHMARK_VERSION}")
+        set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+        set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+        FetchContent_MakeAvailable(benchmark)
+        set(CL_BENCHMARK_FETCHED ON)
+    endif ()
+
+    target_link_libraries(${target} benchmark::benchmark_main)
+endmacro()
+
 # GLM
 set(CL_GLM_VERSION 0.9.9.8)
 set(CL_GLM_FETCHED OFF)
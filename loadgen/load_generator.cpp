@@ -0,0 +1,428 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "codec.hpp"
+#include "load_generator.hpp"
+
+namespace fox {
+    namespace {
+        auto get_timeout(kstd::u32 fetch_wait) noexcept -> std::chrono::milliseconds {
+            // A waiting fetch must not look like a dead connection
+            return std::chrono::milliseconds(fetch_wait) + std::chrono::seconds(10);
+        }
+
+        auto to_steady_duration(double seconds) noexcept -> std::chrono::steady_clock::duration {
+            return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        auto record_enqueue_result(LoadStats& stats, const std::string& res_body, kstd::usize task_count) noexcept -> void {
+            const auto body = nlohmann::json::parse(res_body, nullptr, false);
+
+            if (!body.is_object() || !body.contains("queued") || !body["queued"].is_number_unsigned()) {
+                stats.record_tasks(task_count, task_count);
+                return;
+            }
+
+            const auto queued_count = std::min(static_cast<kstd::usize>(body["queued"]), task_count);
+            stats.record_tasks(task_count, task_count - queued_count);
+        }
+
+        auto to_milliseconds(kstd::u64 microseconds) noexcept -> double {
+            return static_cast<double>(microseconds) / 1000.0;
+        }
+    }
+
+    auto LoadStats::print(std::chrono::duration<double> elapsed) const noexcept -> void {
+        const auto seconds = std::max(elapsed.count(), 1e-9);
+        kstd::u64 total_count = 0;
+
+        spdlog::info("Ran for {:.1f}s", seconds);
+        // Latencies are bucket upper bounds, so they overestimate by up to 25%
+        spdlog::info("{:<12} {:>10} {:>10} {:>8} {:>10} {:>10} {:>10}", "endpoint", "requests", "rps", "errors", "p50 ms", "p99 ms", "p999 ms");
+
+        for (kstd::usize i = 0; i < request_kind_count; ++i) {
+            const auto& stats = _kinds[i];
+            const auto count = stats.requests.load();
+
+            if (count == 0) {
+                continue;
+            }
+
+            total_count += count;
+
+            spdlog::info("{:<12} {:>10} {:>10.1f} {:>7.2f}% {:>10.3f} {:>10.3f} {:>10.3f}", get_request_path(static_cast<RequestKind>(i)), count,
+                static_cast<double>(count) / seconds, 100.0 * static_cast<double>(stats.errors.load()) / static_cast<double>(count),
+                to_milliseconds(stats.latency.get_quantile(0.5)), to_milliseconds(stats.latency.get_quantile(0.99)),
+                to_milliseconds(stats.latency.get_quantile(0.999)));
+        }
+
+        spdlog::info("{} requests in total, {:.1f} per second", total_count, static_cast<double>(total_count) / seconds);
+
+        const auto sent_count = _sent_tasks.load();
+
+        if (sent_count > 0) {
+            const auto rejected_count = _rejected_tasks.load();
+            spdlog::info("{} tasks enqueued, {} of them rejected ({:.2f}%)", sent_count, rejected_count,
+                100.0 * static_cast<double>(rejected_count) / static_cast<double>(sent_count));
+        }
+    }
+
+    LoadGenerator::LoadGenerator(LoadConfig config, TrafficRecorder* recorder) noexcept:
+            _config(std::move(config)),
+            _recorder(recorder),
+            _is_running(false) {
+    }
+
+    auto LoadGenerator::make_client() const noexcept -> httplib::Client {
+        httplib::Client client(_config.address, static_cast<kstd::i32>(_config.port));
+        client.set_keep_alive(true);
+        client.set_read_timeout(get_timeout(_config.fetch_wait));
+        return client;
+    }
+
+    auto LoadGenerator::open_session(httplib::Client& client, const std::string& device) noexcept -> std::optional<std::string> {
+        const auto query = fmt::format("?device={}", device);
+        auto body = nlohmann::json::object();
+        body["password"] = _config.password;
+
+        // Going offline ends the session, otherwise /newsession refuses
+        body["is_online"] = false;
+        static_cast<void>(client.Post("/setonline" + query, body.dump(), FOX_JSON_MIME_TYPE));
+        body["is_online"] = true;
+        static_cast<void>(client.Post("/setonline" + query, body.dump(), FOX_JSON_MIME_TYPE));
+        body.erase("is_online");
+
+        const auto res = client.Post("/newsession" + query, body.dump(), FOX_JSON_MIME_TYPE);
+
+        if (!res) {
+            spdlog::error("Could not reach the gateway: {}", httplib::to_string(res.error()));
+            return std::nullopt;
+        }
+
+        const auto res_body = nlohmann::json::parse(res->body, nullptr, false);
+
+        if (res->status != 200 || !res_body.is_object() || !res_body.contains("password") || !res_body["password"].is_string()) {
+            spdlog::error("Could not open a session on device {}, status {}", device, res->status);
+            return std::nullopt;
+        }
+
+        return res_body["password"].get<std::string>();
+    }
+
+    auto LoadGenerator::authenticate(httplib::Client& client, const Session& session) noexcept -> std::optional<std::string> {
+        auto body = nlohmann::json::object();
+        body["password"] = session.password;
+
+        const auto res = client.Post(fmt::format("/authenticate?device={}", session.device), body.dump(), FOX_JSON_MIME_TYPE);
+
+        if (!res || res->status != 200) {
+            return std::nullopt;
+        }
+
+        const auto res_body = nlohmann::json::parse(res->body, nullptr, false);
+
+        if (!res_body.is_object() || !res_body.contains("token") || !res_body["token"].is_string()) {
+            return std::nullopt;
+        }
+
+        return res_body["token"].get<std::string>();
+    }
+
+    auto LoadGenerator::open_sessions(const std::vector<std::string>& devices) noexcept -> bool {
+        auto client = make_client();
+        _sessions.clear();
+
+        for (const auto& device: devices) {
+            auto password = open_session(client, device);
+
+            if (!password) {
+                return false;
+            }
+
+            _sessions.push_back({device, std::move(*password)});
+        }
+
+        return true;
+    }
+
+    auto LoadGenerator::send(httplib::Client& client, RequestKind kind, const std::string& device, const std::string& token,
+        nlohmann::json body, std::chrono::steady_clock::time_point start) noexcept -> std::optional<std::string> {
+        if (_recorder != nullptr) {
+            _recorder->record(kind, device, body);
+        }
+
+        httplib::Headers headers;
+
+        if (is_controller_request(kind)) {
+            body["password"] = _config.password;
+        }
+        else if (!token.empty()) {
+            headers.emplace("Authorization", fmt::format("Bearer {}", token));
+        }
+
+        auto res = client.Post(fmt::format("{}?device={}", get_request_path(kind), device), headers, body.dump(), FOX_JSON_MIME_TYPE);
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        const auto is_ok = res && res->status == 200;
+        _stats.record(kind, latency, is_ok);
+
+        if (!is_ok) {
+            return std::nullopt;
+        }
+
+        return std::move(res->body);
+    }
+
+    auto LoadGenerator::make_tasks(std::mt19937& generator) const noexcept -> nlohmann::json {
+        std::uniform_int_distribution<kstd::u32> type_dist(0, static_cast<kstd::u32>(dto::task_type_count - 1));
+        std::uniform_int_distribution<kstd::u32> speed_dist(0, 100);
+        auto tasks = nlohmann::json::array();
+
+        for (kstd::u32 i = 0; i < _config.batch_size; ++i) {
+            const auto type = static_cast<dto::TaskType>(type_dist(generator));
+            dto::Task task{};
+
+            switch (type) {
+                case dto::TaskType::POWER:
+                    static_cast<void>(task.set_value(type, speed_dist(generator) % 2));
+                    break;
+                case dto::TaskType::SPEED:
+                    static_cast<void>(task.set_value(type, speed_dist(generator)));
+                    break;
+                case dto::TaskType::MODE:
+                    static_cast<void>(task.set_value(type, static_cast<kstd::u32>(dto::Mode::DEFAULT)));
+                    break;
+            }
+
+            auto task_obj = nlohmann::json::object();
+            task.serialize(task_obj);
+            tasks.push_back(task_obj);
+        }
+
+        return tasks;
+    }
+
+    auto LoadGenerator::run_client(kstd::usize index) noexcept -> void {
+        const auto& session = _sessions[index % _sessions.size()];
+        auto client = make_client();
+        auto token = authenticate(client, session).value_or("");
+
+        std::mt19937 generator(static_cast<kstd::u32>(index));
+        std::uniform_int_distribution<kstd::u32> kind_dist(0, _config.enqueue_weight + _config.getstate_weight - 1);
+
+        // Open loop when rate limited, every request has a due time and is charged for being late
+        const auto interval = _config.rate > 0 ? to_steady_duration(static_cast<double>(_config.client_count) / _config.rate) : std::chrono::steady_clock::duration::zero();
+        auto due = std::chrono::steady_clock::now();
+
+        while (_is_running) {
+            auto start = std::chrono::steady_clock::now();
+
+            if (_config.rate > 0) {
+                due += interval;
+                std::this_thread::sleep_until(due);
+                start = due;
+            }
+
+            const auto kind = kind_dist(generator) < _config.enqueue_weight ? RequestKind::ENQUEUE : RequestKind::GETSTATE;
+            auto body = nlohmann::json::object();
+
+            if (kind == RequestKind::ENQUEUE) {
+                body["tasks"] = make_tasks(generator);
+            }
+
+            const auto res_body = send(client, kind, session.device, token, std::move(body), start);
+
+            if (!res_body) {
+                // Most likely an expired token, everything else shows up in the error rate
+                token = authenticate(client, session).value_or(token);
+                continue;
+            }
+
+            if (kind == RequestKind::ENQUEUE) {
+                record_enqueue_result(_stats, *res_body, _config.batch_size);
+            }
+        }
+    }
+
+    auto LoadGenerator::run_controller(kstd::usize index) noexcept -> void {
+        const auto& session = _sessions[index];
+        auto client = make_client();
+        dto::DeviceState state{true, true, 0, 0, dto::Mode::DEFAULT};
+        dto::DeviceState reported_state = state;
+        auto changed_fields = dto::all_fields<dto::DeviceState>; // The first report is complete
+
+        // Only what changed since the last report, like a real controller would
+        const auto make_report = [&] {
+            changed_fields |= dto::diff_fields(reported_state, state);
+            auto state_obj = nlohmann::json::object();
+            dto::serialize_fields(state, state_obj, changed_fields);
+            reported_state = state;
+            changed_fields = 0;
+            return state_obj;
+        };
+
+        while (_is_running) {
+            auto fetch_body = nlohmann::json::object();
+            fetch_body["wait_ms"] = _config.fetch_wait;
+            auto fetch_kind = RequestKind::FETCH;
+
+            if (_config.use_sync) {
+                fetch_body["state"] = make_report();
+                fetch_kind = RequestKind::SYNC;
+            }
+
+            if (const auto res_body = send(client, fetch_kind, session.device, {}, std::move(fetch_body), std::chrono::steady_clock::now())) {
+                const auto body = nlohmann::json::parse(*res_body, nullptr, false);
+
+                if (body.is_object() && body.contains("tasks") && body["tasks"].is_array()) {
+                    for (const auto& task_obj: body["tasks"]) {
+                        dto::Task task{};
+
+                        try {
+                            task.deserialize(task_obj);
+                        }
+                        catch (const std::exception&) {
+                            continue;
+                        }
+
+                        switch (task.type) {
+                            case dto::TaskType::POWER:
+                                state.is_on = task.power.is_on;
+                                break;
+                            case dto::TaskType::SPEED:
+                                state.target_speed = static_cast<kstd::u32>(task.speed.speed);
+                                break;
+                            case dto::TaskType::MODE:
+                                state.mode = task.mode.mode;
+                                break;
+                        }
+                    }
+                }
+            }
+
+            // Like a real fan, the actual speed creeps towards the target, so nearly every report differs
+            state.actual_speed = (state.actual_speed + (state.is_on ? state.target_speed : 0) + 1) / 2;
+
+            if (_config.use_sync) {
+                continue; // Reported along with the next fetch
+            }
+
+            auto state_body = nlohmann::json::object();
+            state_body["state"] = make_report();
+            static_cast<void>(send(client, RequestKind::SETSTATE, session.device, {}, std::move(state_body), std::chrono::steady_clock::now()));
+        }
+    }
+
+    auto LoadGenerator::run_replay(const std::vector<TrafficEntry>& entries, kstd::usize index, double speed, std::chrono::steady_clock::time_point start) noexcept -> void {
+        auto client = make_client();
+        std::unordered_map<std::string, std::string> tokens;
+
+        for (auto i = index; i < entries.size(); i += _config.client_count) {
+            const auto& entry = entries[i];
+            const auto due = start + to_steady_duration(static_cast<double>(entry.offset) / 1e6 / speed);
+            std::this_thread::sleep_until(due);
+
+            std::string* token = nullptr;
+
+            if (!is_controller_request(entry.kind)) {
+                token = &tokens[entry.device];
+
+                if (token->empty()) {
+                    const auto session = std::find_if(_sessions.begin(), _sessions.end(), [&entry](const Session& value) {
+                        return value.device == entry.device;
+                    });
+
+                    *token = authenticate(client, *session).value_or("");
+                }
+            }
+
+            const auto res_body = send(client, entry.kind, entry.device, token != nullptr ? *token : std::string(), entry.body, due);
+
+            if (!res_body) {
+                if (token != nullptr) {
+                    token->clear(); // Authenticate again on the next request for this device
+                }
+
+                continue;
+            }
+
+            if (entry.kind == RequestKind::ENQUEUE && entry.body.contains("tasks") && entry.body["tasks"].is_array()) {
+                record_enqueue_result(_stats, *res_body, entry.body["tasks"].size());
+            }
+        }
+    }
+
+    auto LoadGenerator::run() noexcept -> bool {
+        std::vector<std::string> devices;
+
+        for (kstd::u32 i = 0; i < _config.device_count; ++i) {
+            devices.push_back(fmt::format("loadgen-{}", i));
+        }
+
+        if (!open_sessions(devices)) {
+            return false;
+        }
+
+        spdlog::info("Generating load with {} controllers and {} clients for {}s", _config.device_count, _config.client_count, _config.duration.count());
+
+        _is_running = true;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+
+        for (kstd::usize i = 0; i < _config.device_count; ++i) {
+            threads.emplace_back(&LoadGenerator::run_controller, this, i);
+        }
+
+        for (kstd::usize i = 0; i < _config.client_count; ++i) {
+            threads.emplace_back(&LoadGenerator::run_client, this, i);
+        }
+
+        std::this_thread::sleep_for(_config.duration);
+        _is_running = false;
+
+        for (auto& thread: threads) {
+            thread.join();
+        }
+
+        _stats.print(std::chrono::steady_clock::now() - start);
+        return true;
+    }
+
+    auto LoadGenerator::replay(const std::vector<TrafficEntry>& entries, double speed) noexcept -> bool {
+        std::vector<std::string> devices;
+
+        for (const auto& entry: entries) {
+            if (std::find(devices.begin(), devices.end(), entry.device) == devices.end()) {
+                devices.push_back(entry.device);
+            }
+        }
+
+        if (!open_sessions(devices)) {
+            return false;
+        }
+
+        spdlog::info("Replaying {} requests to {} devices at {}x speed", entries.size(), devices.size(), speed);
+
+        _is_running = true;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+
+        for (kstd::usize i = 0; i < _config.client_count; ++i) {
+            threads.emplace_back(&LoadGenerator::run_replay, this, std::cref(entries), i, speed, start);
+        }
+
+        for (auto& thread: threads) {
+            thread.join();
+        }
+
+        _is_running = false;
+        _stats.print(std::chrono::steady_clock::now() - start);
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <kstd/types.hpp>
+#include <nlohmann/json.hpp>
+#include <httplib.h>
+
+#include "dto.hpp"
+#include "metrics.hpp"
+#include "traffic_log.hpp"
+
+namespace fox {
+    struct LoadConfig final {
+        std::string address;
+        kstd::u32 port;
+        std::string password; // Of the gateway, sessions are opened through /newsession
+        kstd::u32 device_count; // Every device gets one controller
+        kstd::u32 client_count; // Spread round-robin over the devices, each on its own keep-alive connection
+        kstd::u32 enqueue_weight;
+        kstd::u32 getstate_weight;
+        kstd::u32 batch_size; // Tasks per /enqueue
+        kstd::u32 fetch_wait; // In milliseconds, passed to /fetch as wait_ms
+        bool use_sync; // Controllers report and fetch in one /sync instead of /fetch followed by /setstate
+        double rate; // Client requests per second over all clients, 0 sends as fast as the gateway answers
+        std::chrono::seconds duration;
+    };
+
+    /**
+     * Latencies and outcomes of every request sent, per endpoint.
+     */
+    class LoadStats final {
+        struct KindStats final {
+            Histogram latency; // In microseconds
+            ShardedCounter requests;
+            ShardedCounter errors;
+        };
+
+        std::array<KindStats, request_kind_count> _kinds;
+        ShardedCounter _sent_tasks;
+        ShardedCounter _rejected_tasks;
+
+        public:
+
+        inline auto record(RequestKind kind, std::chrono::microseconds latency, bool is_ok) noexcept -> void {
+            auto& stats = _kinds[static_cast<kstd::usize>(kind)];
+            stats.latency.record(static_cast<kstd::u64>(latency.count()));
+            stats.requests.add();
+
+            if (!is_ok) {
+                stats.errors.add();
+            }
+        }
+
+        inline auto record_tasks(kstd::usize sent_count, kstd::usize rejected_count) noexcept -> void {
+            _sent_tasks.add(sent_count);
+            _rejected_tasks.add(rejected_count);
+        }
+
+        auto print(std::chrono::duration<double> elapsed) const noexcept -> void;
+    };
+
+    /**
+     * Drives a gateway over HTTP the way real clients and controllers do:
+     * controllers cycle /fetch and /setstate, clients authenticate with the session of their device
+     * and mix /enqueue batches with /getstate polls.
+     */
+    class LoadGenerator final {
+        struct Session final {
+            std::string device;
+            std::string password;
+        };
+
+        LoadConfig _config;
+        TrafficRecorder* _recorder;
+        LoadStats _stats;
+        std::atomic_bool _is_running;
+        std::vector<Session> _sessions;
+
+        [[nodiscard]] auto make_client() const noexcept -> httplib::Client;
+
+        /**
+         * Takes the device online and starts a new session on it, ending whatever session a previous run left behind.
+         */
+        [[nodiscard]] auto open_session(httplib::Client& client, const std::string& device) noexcept -> std::optional<std::string>;
+
+        [[nodiscard]] auto authenticate(httplib::Client& client, const Session& session) noexcept -> std::optional<std::string>;
+
+        [[nodiscard]] auto open_sessions(const std::vector<std::string>& devices) noexcept -> bool;
+
+        /**
+         * Sends a single request, filling in the server password or the bearer token, and records its outcome.
+         * Latency is measured from the given start, so requests which were due earlier are charged for the delay.
+         * @return The response body, or nothing if the request failed.
+         */
+        [[nodiscard]] auto send(httplib::Client& client, RequestKind kind, const std::string& device, const std::string& token,
+            nlohmann::json body, std::chrono::steady_clock::time_point start) noexcept -> std::optional<std::string>;
+
+        auto run_client(kstd::usize index) noexcept -> void;
+
+        auto run_controller(kstd::usize index) noexcept -> void;
+
+        auto run_replay(const std::vector<TrafficEntry>& entries, kstd::usize index, double speed, std::chrono::steady_clock::time_point start) noexcept -> void;
+
+        [[nodiscard]] auto make_tasks(std::mt19937& generator) const noexcept -> nlohmann::json;
+
+        public:
+
+        /**
+         * @param recorder Receives every request sent, null to record nothing.
+         */
+        LoadGenerator(LoadConfig config, TrafficRecorder* recorder) noexcept;
+
+        LoadGenerator(const LoadGenerator&) = delete;
+
+        auto operator =(const LoadGenerator&) -> LoadGenerator& = delete;
+
+        /**
+         * Generates load for the configured duration and prints what the gateway achieved.
+         * @return False if the sessions could not be set up.
+         */
+        [[nodiscard]] auto run() noexcept -> bool;
+
+        /**
+         * Sends the given recording again, with its timing scaled by speed, so 2 replays twice as fast.
+         * @return False if the sessions could not be set up.
+         */
+        [[nodiscard]] auto replay(const std::vector<TrafficEntry>& entries, double speed) noexcept -> bool;
+
+        [[nodiscard]] inline auto get_stats() const noexcept -> const LoadStats& {
+            return _stats;
+        }
+    };
+}
\ No newline at end of file
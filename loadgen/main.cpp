@@ -0,0 +1,120 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <iostream>
+#include <string>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <cxxopts/cxxopts.hpp>
+#include "load_generator.hpp"
+
+auto main(int num_args, char** args) -> int {
+    spdlog::set_default_logger(spdlog::create<spdlog::sinks::stdout_color_sink_mt>("FoxControl"));
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[%H:%M:%S] [%n] [%^---%L---%$] %v");
+
+    auto option_spec = cxxopts::Options("fox-control-loadgen", "Generates realistic client and controller traffic against a FoxControl gateway");
+
+    // @formatter:off
+    option_spec.add_options()
+        ("h,help", "Show this help dialog")
+        ("V,verbose", "Enable verbose logging")
+        ("a,address", "Specify the address of the gateway", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+        ("p,port", "Specify the port of the gateway", cxxopts::value<kstd::u32>()->default_value("8080"))
+        ("P,password", "Specify the password of the gateway, used for the controller requests and to open sessions", cxxopts::value<std::string>())
+        ("d,devices", "Specify how many devices to drive, each of them gets its own controller", cxxopts::value<kstd::u32>()->default_value("1"))
+        ("c,clients", "Specify how many clients to run, each on its own keep-alive connection", cxxopts::value<kstd::u32>()->default_value("16"))
+        ("enqueue-weight", "Specify the relative share of /enqueue in the client requests", cxxopts::value<kstd::u32>()->default_value("1"))
+        ("getstate-weight", "Specify the relative share of /getstate in the client requests", cxxopts::value<kstd::u32>()->default_value("4"))
+        ("b,batch", "Specify how many tasks every /enqueue carries", cxxopts::value<kstd::u32>()->default_value("4"))
+        ("fetch-wait", "Specify for how many milliseconds a controller /fetch may wait for tasks", cxxopts::value<kstd::u32>()->default_value("100"))
+        ("sync", "Let the controllers use a single /sync per cycle instead of /fetch and /setstate")
+        ("r,rate", "Specify how many client requests to send per second in total, 0 sends as fast as the gateway answers", cxxopts::value<double>()->default_value("0"))
+        ("t,duration", "Specify for how many seconds to generate load", cxxopts::value<kstd::u32>()->default_value("10"))
+        ("record", "Specify a file to which every request sent is recorded", cxxopts::value<std::string>()->default_value(""))
+        ("replay", "Specify a recording to send again instead of generating load", cxxopts::value<std::string>()->default_value(""))
+        ("speed", "Specify how much faster than recorded to replay, 2 halves every delay", cxxopts::value<double>()->default_value("1"));
+    // @formatter:on
+
+    cxxopts::ParseResult options;
+
+    try {
+        options = option_spec.parse(num_args, args);
+    }
+    catch (const std::exception& error) {
+        spdlog::error("Malformed arguments: {}", error.what());
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cout << option_spec.help() << std::endl;
+        return 0;
+    }
+
+    if (options.count("verbose") > 0) {
+        spdlog::set_level(spdlog::level::debug);
+        spdlog::debug("Verbose logging enabled");
+    }
+
+    if (options.count("password") == 0) {
+        spdlog::error("The password of the gateway is required");
+        return 1;
+    }
+
+    fox::LoadConfig config{
+        options["address"].as<std::string>(),
+        options["port"].as<kstd::u32>(),
+        options["password"].as<std::string>(),
+        options["devices"].as<kstd::u32>(),
+        options["clients"].as<kstd::u32>(),
+        options["enqueue-weight"].as<kstd::u32>(),
+        options["getstate-weight"].as<kstd::u32>(),
+        options["batch"].as<kstd::u32>(),
+        options["fetch-wait"].as<kstd::u32>(),
+        options.count("sync") > 0,
+        options["rate"].as<double>(),
+        std::chrono::seconds(options["duration"].as<kstd::u32>())
+    };
+
+    if (config.device_count == 0 || config.client_count == 0) {
+        spdlog::error("At least one device and one client are required");
+        return 1;
+    }
+
+    if (config.enqueue_weight + config.getstate_weight == 0 || config.rate < 0) {
+        spdlog::error("Malformed request mix or rate");
+        return 1;
+    }
+
+    const auto speed = options["speed"].as<double>();
+
+    if (speed <= 0) {
+        spdlog::error("Replay speed has to be positive");
+        return 1;
+    }
+
+    fox::TrafficRecorder recorder;
+    const auto record_path = options["record"].as<std::string>();
+
+    if (!record_path.empty() && !recorder.open(record_path)) {
+        spdlog::error("Could not open {} for recording", record_path);
+        return 1;
+    }
+
+    fox::LoadGenerator generator(std::move(config), record_path.empty() ? nullptr : &recorder);
+    const auto replay_path = options["replay"].as<std::string>();
+
+    if (replay_path.empty()) {
+        return generator.run() ? 0 : 1;
+    }
+
+    const auto entries = fox::load_traffic(replay_path);
+
+    if (!entries) {
+        return 1;
+    }
+
+    return generator.replay(*entries, speed) ? 0 : 1;
+}
\ No newline at end of file
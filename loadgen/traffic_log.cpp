@@ -0,0 +1,93 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include "traffic_log.hpp"
+
+namespace fox {
+    namespace {
+        constexpr std::array<std::string_view, request_kind_count> request_paths = {"/enqueue", "/getstate", "/fetch", "/setstate", "/sync"};
+    }
+
+    auto get_request_path(RequestKind kind) noexcept -> std::string_view {
+        return request_paths[static_cast<kstd::usize>(kind)];
+    }
+
+    auto parse_request_kind(std::string_view path) noexcept -> std::optional<RequestKind> {
+        const auto itr = std::find(request_paths.begin(), request_paths.end(), path);
+
+        if (itr == request_paths.end()) {
+            return std::nullopt;
+        }
+
+        return static_cast<RequestKind>(itr - request_paths.begin());
+    }
+
+    auto TrafficRecorder::open(const std::filesystem::path& path) noexcept -> bool {
+        _file.open(path, std::ios::trunc);
+        _start = std::chrono::steady_clock::now();
+        return _file.is_open();
+    }
+
+    auto TrafficRecorder::record(RequestKind kind, std::string_view device, const nlohmann::json& body) noexcept -> void {
+        const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start);
+
+        auto entry = nlohmann::json::object();
+        entry["t"] = static_cast<kstd::u64>(offset.count());
+        entry["path"] = get_request_path(kind);
+        entry["device"] = device;
+        entry["body"] = body;
+        const auto line = entry.dump();
+
+        const std::lock_guard lock(_mutex);
+        _file << line << '\n';
+    }
+
+    auto load_traffic(const std::filesystem::path& path) noexcept -> std::optional<std::vector<TrafficEntry>> {
+        std::ifstream file(path);
+
+        if (!file.is_open()) {
+            spdlog::error("Could not open recording {}", path.string());
+            return std::nullopt;
+        }
+
+        std::vector<TrafficEntry> entries;
+        std::string line;
+
+        for (kstd::usize line_number = 1; std::getline(file, line); ++line_number) {
+            if (line.empty()) {
+                continue;
+            }
+
+            const auto entry = nlohmann::json::parse(line, nullptr, false);
+
+            if (!entry.is_object() || !entry.contains("t") || !entry["t"].is_number_unsigned()
+                || !entry.contains("path") || !entry["path"].is_string()
+                || !entry.contains("device") || !entry["device"].is_string()
+                || !entry.contains("body") || !entry["body"].is_object()) {
+                spdlog::error("Malformed entry in line {} of {}", line_number, path.string());
+                return std::nullopt;
+            }
+
+            const auto kind = parse_request_kind(entry["path"].get_ref<const std::string&>());
+
+            if (!kind) {
+                spdlog::error("Unknown endpoint in line {} of {}", line_number, path.string());
+                return std::nullopt;
+            }
+
+            entries.push_back({static_cast<kstd::u64>(entry["t"]), *kind, entry["device"], entry["body"]});
+        }
+
+        // Lines are written by several threads, so they're only roughly in order
+        std::stable_sort(entries.begin(), entries.end(), [](const TrafficEntry& a, const TrafficEntry& b) {
+            return a.offset < b.offset;
+        });
+
+        return entries;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <kstd/types.hpp>
+#include <nlohmann/json.hpp>
+
+namespace fox {
+    enum class RequestKind : kstd::u8 {
+        ENQUEUE,
+        GETSTATE,
+        FETCH,
+        SETSTATE,
+        SYNC
+    };
+
+    static constexpr kstd::usize request_kind_count = 5;
+
+    [[nodiscard]] auto get_request_path(RequestKind kind) noexcept -> std::string_view;
+
+    [[nodiscard]] auto parse_request_kind(std::string_view path) noexcept -> std::optional<RequestKind>;
+
+    /**
+     * @return True for the requests the controller sends with the server password, false for client requests.
+     */
+    [[nodiscard]] inline auto is_controller_request(RequestKind kind) noexcept -> bool {
+        return kind == RequestKind::FETCH || kind == RequestKind::SETSTATE || kind == RequestKind::SYNC;
+    }
+
+    struct TrafficEntry final {
+        kstd::u64 offset; // Microseconds since the recording started
+        RequestKind kind;
+        std::string device;
+        nlohmann::json body; // Without credentials, those belong to the session of whoever replays it
+    };
+
+    /**
+     * Appends every request sent to a file, one JSON object per line, so a run can be replayed later.
+     */
+    class TrafficRecorder final {
+        std::mutex _mutex;
+        std::ofstream _file;
+        std::chrono::steady_clock::time_point _start;
+
+        public:
+
+        TrafficRecorder() noexcept = default;
+
+        TrafficRecorder(const TrafficRecorder&) = delete;
+
+        auto operator =(const TrafficRecorder&) -> TrafficRecorder& = delete;
+
+        /**
+         * Opens the given file, discarding whatever it held before, and starts the clock of the recording.
+         */
+        [[nodiscard]] auto open(const std::filesystem::path& path) noexcept -> bool;
+
+        auto record(RequestKind kind, std::string_view device, const nlohmann::json& body) noexcept -> void;
+    };
+
+    /**
+     * Reads a recording made by TrafficRecorder, ordered by offset.
+     * @return Nothing if the file could not be read or holds a malformed entry.
+     */
+    [[nodiscard]] auto load_traffic(const std::filesystem::path& path) noexcept -> std::optional<std::vector<TrafficEntry>>;
+}
\ No newline at end of file
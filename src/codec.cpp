@@ -0,0 +1,134 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <cctype>
+#include <algorithm>
+#include "codec.hpp"
+
+namespace fox::codec {
+    namespace {
+        auto trim(std::string_view value) noexcept -> std::string_view {
+            while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) {
+                value.remove_prefix(1);
+            }
+
+            while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) {
+                value.remove_suffix(1);
+            }
+
+            return value;
+        }
+
+        auto equals_ignore_case(std::string_view a, std::string_view b) noexcept -> bool {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+    }
+
+    auto parse_format(std::string_view mime_types) noexcept -> std::optional<WireFormat> {
+        while (!mime_types.empty()) {
+            const auto separator = mime_types.find(',');
+            auto entry = mime_types.substr(0, separator);
+            entry = trim(entry.substr(0, entry.find(';'))); // Ignore parameters like charset or q
+            mime_types = separator == std::string_view::npos ? std::string_view() : mime_types.substr(separator + 1);
+
+            if (equals_ignore_case(entry, FOX_JSON_MIME_TYPE)) {
+                return WireFormat::JSON;
+            }
+
+            if (equals_ignore_case(entry, FOX_CBOR_MIME_TYPE)) {
+                return WireFormat::CBOR;
+            }
+
+            if (equals_ignore_case(entry, FOX_MSGPACK_MIME_TYPE) || equals_ignore_case(entry, "application/x-msgpack")) {
+                return WireFormat::MSGPACK;
+            }
+
+            if (equals_ignore_case(entry, FOX_PACKED_MIME_TYPE)) {
+                return WireFormat::PACKED;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    auto get_mime_type(WireFormat format) noexcept -> const char* {
+        switch (format) {
+            case WireFormat::CBOR:
+                return FOX_CBOR_MIME_TYPE;
+            case WireFormat::MSGPACK:
+                return FOX_MSGPACK_MIME_TYPE;
+            case WireFormat::PACKED:
+                return FOX_PACKED_MIME_TYPE;
+            default:
+                return FOX_JSON_MIME_TYPE;
+        }
+    }
+
+    auto get_input_format(WireFormat format) noexcept -> nlohmann::json::input_format_t {
+        switch (format) {
+            case WireFormat::CBOR:
+                return nlohmann::json::input_format_t::cbor;
+            case WireFormat::MSGPACK:
+                return nlohmann::json::input_format_t::msgpack;
+            default:
+                return nlohmann::json::input_format_t::json;
+        }
+    }
+
+    auto split_packed(std::string_view body) noexcept -> std::optional<PackedBody> {
+        if (body.empty()) {
+            return std::nullopt;
+        }
+
+        const auto password_length = static_cast<kstd::u8>(body[0]);
+
+        if (body.size() < 1 + static_cast<kstd::usize>(password_length)) {
+            return std::nullopt;
+        }
+
+        return {{body.substr(1, password_length), body.substr(1 + password_length)}};
+    }
+
+    auto decode(WireFormat format, const std::string& body) -> nlohmann::json {
+        switch (format) {
+            case WireFormat::CBOR:
+                return nlohmann::json::from_cbor(body, true, false);
+            case WireFormat::MSGPACK:
+                return nlohmann::json::from_msgpack(body, true, false);
+            case WireFormat::PACKED: {
+                const auto packed = split_packed(body);
+
+                if (!packed) {
+                    return nlohmann::json(nlohmann::json::value_t::discarded);
+                }
+
+                auto json = nlohmann::json::object();
+                json["password"] = packed->password;
+                return json;
+            }
+            default:
+                return nlohmann::json::parse(body);
+        }
+    }
+
+    auto encode(WireFormat format, const nlohmann::json& json) -> std::string {
+        switch (format) {
+            case WireFormat::CBOR: {
+                std::string result;
+                nlohmann::json::to_cbor(json, result);
+                return result;
+            }
+            case WireFormat::MSGPACK: {
+                std::string result;
+                nlohmann::json::to_msgpack(json, result);
+                return result;
+            }
+            default:
+                return json.dump();
+        }
+    }
+}
\ No newline at end of file
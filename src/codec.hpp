@@ -0,0 +1,60 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <kstd/types.hpp>
+#include <nlohmann/json.hpp>
+
+#define FOX_JSON_MIME_TYPE "application/json"
+#define FOX_CBOR_MIME_TYPE "application/cbor"
+#define FOX_MSGPACK_MIME_TYPE "application/msgpack"
+#define FOX_PACKED_MIME_TYPE "application/x-fox-packed"
+
+namespace fox::codec {
+    enum class WireFormat : kstd::u8 {
+        JSON,
+        CBOR,
+        MSGPACK,
+        PACKED
+    };
+
+    /**
+     * Every packed request body starts with [password_length: u8][password],
+     * followed by the fixed-size records of the endpoint.
+     */
+    struct PackedBody final {
+        std::string_view password;
+        std::string_view payload;
+    };
+
+    /**
+     * Parses a Content-Type or Accept header value, the first supported entry of a list wins.
+     */
+    [[nodiscard]] auto parse_format(std::string_view mime_types) noexcept -> std::optional<WireFormat>;
+
+    [[nodiscard]] auto get_mime_type(WireFormat format) noexcept -> const char*;
+
+    /**
+     * Maps a wire format onto the matching input format of the bundled parser, packed maps onto JSON.
+     */
+    [[nodiscard]] auto get_input_format(WireFormat format) noexcept -> nlohmann::json::input_format_t;
+
+    [[nodiscard]] auto split_packed(std::string_view body) noexcept -> std::optional<PackedBody>;
+
+    /**
+     * Decodes a request body into a JSON document, packed bodies only yield their password.
+     * Malformed binary bodies result in a discarded value, malformed JSON throws as before.
+     */
+    [[nodiscard]] auto decode(WireFormat format, const std::string& body) -> nlohmann::json;
+
+    /**
+     * Encodes a response document, falling back to JSON for the packed format.
+     */
+    [[nodiscard]] auto encode(WireFormat format, const nlohmann::json& json) -> std::string;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <string_view>
+#include <kstd/types.hpp>
+
+#include "crypto.hpp"
+#include "seqlock.hpp"
+
+namespace fox {
+    /**
+     * A password which is only ever kept as its SHA-256 digest.
+     * Checks are lock-free and take the same time regardless of where or whether the input differs.
+     */
+    class Credential final {
+        struct Entry final {
+            crypto::Digest digest;
+            bool is_set;
+        };
+
+        SeqLock<Entry> _entry;
+
+        public:
+
+        Credential() noexcept = default;
+
+        explicit Credential(std::string_view password) noexcept {
+            set(password);
+        }
+
+        inline auto set(std::string_view password) noexcept -> void {
+            _entry.store({crypto::sha256(password), !password.empty()});
+        }
+
+        inline auto clear() noexcept -> void {
+            _entry.store({});
+        }
+
+        [[nodiscard]] inline auto is_set() const noexcept -> bool {
+            return _entry.load().is_set;
+        }
+
+        [[nodiscard]] inline auto matches(std::string_view password) const noexcept -> bool {
+            if (password.empty()) {
+                return false;
+            }
+
+            // Hashing first means the comparison always covers the same number of bytes
+            const auto digest = crypto::sha256(password);
+            const auto entry = _entry.load();
+            return crypto::constant_time_equals(digest, entry.digest) && entry.is_set;
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <bit>
+#include <cstring>
+#include <random>
+#include <algorithm>
+#include "crypto.hpp"
+
+namespace fox::crypto {
+    namespace {
+        constexpr std::array<kstd::u32, 64> round_constants = {
+            0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+            0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+            0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+            0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+            0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+            0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+            0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+            0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+        };
+
+        auto process_block(std::array<kstd::u32, 8>& state, const kstd::u8* block) noexcept -> void {
+            std::array<kstd::u32, 64> schedule{};
+
+            for (kstd::usize i = 0; i < 16; ++i) {
+                schedule[i] = (static_cast<kstd::u32>(block[i * 4]) << 24)
+                    | (static_cast<kstd::u32>(block[i * 4 + 1]) << 16)
+                    | (static_cast<kstd::u32>(block[i * 4 + 2]) << 8)
+                    | static_cast<kstd::u32>(block[i * 4 + 3]);
+            }
+
+            for (kstd::usize i = 16; i < 64; ++i) {
+                const auto s0 = std::rotr(schedule[i - 15], 7) ^ std::rotr(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+                const auto s1 = std::rotr(schedule[i - 2], 17) ^ std::rotr(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+                schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+            }
+
+            auto [a, b, c, d, e, f, g, h] = state;
+
+            for (kstd::usize i = 0; i < 64; ++i) {
+                const auto s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+                const auto choice = (e & f) ^ (~e & g);
+                const auto temp1 = h + s1 + choice + round_constants[i] + schedule[i];
+                const auto s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+                const auto majority = (a & b) ^ (a & c) ^ (b & c);
+                const auto temp2 = s0 + majority;
+
+                h = g;
+                g = f;
+                f = e;
+                e = d + temp1;
+                d = c;
+                c = b;
+                b = a;
+                a = temp1 + temp2;
+            }
+
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+    }
+
+    Sha256::Sha256() noexcept:
+            _state({0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19}),
+            _block(),
+            _block_size(0),
+            _total_size(0) {
+    }
+
+    auto Sha256::update(std::string_view data) noexcept -> Sha256& {
+        const auto* bytes = reinterpret_cast<const kstd::u8*>(data.data());
+        kstd::usize remaining = data.size();
+        _total_size += remaining;
+
+        if (_block_size > 0) { // Top up a partial block from a previous update first
+            const auto count = std::min(remaining, _block.size() - _block_size);
+            std::memcpy(_block.data() + _block_size, bytes, count);
+            _block_size += count;
+            bytes += count;
+            remaining -= count;
+
+            if (_block_size < _block.size()) {
+                return *this;
+            }
+
+            process_block(_state, _block.data());
+            _block_size = 0;
+        }
+
+        while (remaining >= _block.size()) {
+            process_block(_state, bytes);
+            bytes += _block.size();
+            remaining -= _block.size();
+        }
+
+        std::memcpy(_block.data(), bytes, remaining);
+        _block_size = remaining;
+        return *this;
+    }
+
+    auto Sha256::finish() noexcept -> Digest {
+        // Padding: 0x80, zeroes and the message length in bits, spilling into a second block if needed
+        std::array<kstd::u8, 128> tail{};
+        std::memcpy(tail.data(), _block.data(), _block_size);
+        tail[_block_size] = 0x80;
+
+        const auto tail_size = _block_size < 56 ? 64 : 128;
+        const auto bit_count = _total_size * 8;
+
+        for (kstd::usize i = 0; i < 8; ++i) {
+            tail[tail_size - 1 - i] = static_cast<kstd::u8>(bit_count >> (i * 8));
+        }
+
+        process_block(_state, tail.data());
+
+        if (tail_size == 128) {
+            process_block(_state, tail.data() + 64);
+        }
+
+        Digest digest{};
+
+        for (kstd::usize i = 0; i < _state.size(); ++i) {
+            digest[i * 4] = static_cast<kstd::u8>(_state[i] >> 24);
+            digest[i * 4 + 1] = static_cast<kstd::u8>(_state[i] >> 16);
+            digest[i * 4 + 2] = static_cast<kstd::u8>(_state[i] >> 8);
+            digest[i * 4 + 3] = static_cast<kstd::u8>(_state[i]);
+        }
+
+        return digest;
+    }
+
+    auto sha256(std::string_view data) noexcept -> Digest {
+        return Sha256().update(data).finish();
+    }
+
+    auto hmac_sha256(const Digest& key, std::string_view message) noexcept -> Digest {
+        // The key is shorter than a block, so it's just zero-padded
+        std::array<char, 64> inner_pad{};
+        std::array<char, 64> outer_pad{};
+
+        for (kstd::usize i = 0; i < inner_pad.size(); ++i) {
+            const auto byte = i < key.size() ? key[i] : kstd::u8(0);
+            inner_pad[i] = static_cast<char>(byte ^ 0x36);
+            outer_pad[i] = static_cast<char>(byte ^ 0x5C);
+        }
+
+        const auto inner = Sha256().update({inner_pad.data(), inner_pad.size()}).update(message).finish();
+        return Sha256()
+            .update({outer_pad.data(), outer_pad.size()})
+            .update({reinterpret_cast<const char*>(inner.data()), inner.size()})
+            .finish();
+    }
+
+    auto generate_key() noexcept -> Digest {
+        std::random_device device;
+        Digest key{};
+
+        for (kstd::usize i = 0; i < key.size(); i += 4) {
+            const auto value = device();
+            std::memcpy(key.data() + i, &value, 4);
+        }
+
+        return key;
+    }
+
+    auto constant_time_equals(const Digest& a, const Digest& b) noexcept -> bool {
+        kstd::u8 difference = 0;
+
+        for (kstd::usize i = 0; i < a.size(); ++i) {
+            difference |= a[i] ^ b[i];
+        }
+
+        return difference == 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string_view>
+#include <kstd/types.hpp>
+
+namespace fox::crypto {
+    using Digest = std::array<kstd::u8, 32>;
+
+    class Sha256 final {
+        std::array<kstd::u32, 8> _state;
+        std::array<kstd::u8, 64> _block;
+        kstd::usize _block_size;
+        kstd::u64 _total_size;
+
+        public:
+
+        Sha256() noexcept;
+
+        auto update(std::string_view data) noexcept -> Sha256&;
+
+        [[nodiscard]] auto finish() noexcept -> Digest;
+    };
+
+    [[nodiscard]] auto sha256(std::string_view data) noexcept -> Digest;
+
+    [[nodiscard]] auto hmac_sha256(const Digest& key, std::string_view message) noexcept -> Digest;
+
+    /**
+     * Generates a random key, suitable for HMAC, from the system's random device.
+     */
+    [[nodiscard]] auto generate_key() noexcept -> Digest;
+
+    /**
+     * Compares both digests without exiting early, so the time taken doesn't depend on where they differ.
+     */
+    [[nodiscard]] auto constant_time_equals(const Digest& a, const Digest& b) noexcept -> bool;
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "device.hpp"
+
+namespace fox {
+    Device::Device(std::string id, const DeviceConfig& config) noexcept:
+            _id(std::move(id)),
+            _backlog(config.backlog),
+            _max_subscribers(config.max_subscribers),
+            _is_open(true),
+            _tasks(config.backlog, config.queue, config.spill_directory.empty() ? std::filesystem::path() : config.spill_directory / _id),
+            _residence_tracker(config.residence_tracker),
+            _waiter_count(0),
+            _task_stream_count(0),
+            _session_tokens(config.token_lifetime),
+            _state_events(config.max_subscribers, config.event_buffer_size),
+            _base_version(static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count())),
+            _state(VersionedState{{}, false, _base_version, {}, 0}),
+            _state_waiter_count(0),
+            _total_task_count(0),
+            _total_processed_count(0) {
+        refresh_state_body();
+
+        if (config.log_directory.empty() || config.log_syncer == nullptr) {
+            return;
+        }
+
+        auto task_log = std::make_unique<TaskLog>(config.log_directory / _id, *config.log_syncer);
+        kstd::usize restored_count = 0;
+        kstd::usize dropped_count = 0;
+
+        const auto is_open = task_log->open([&](kstd::u8 lane, kstd::u64 sequence, const dto::Task& task) {
+            if (_tasks.try_push_to_lane(task, lane, sequence)) {
+                ++restored_count;
+            }
+            else {
+                ++dropped_count;
+            }
+        });
+
+        if (!is_open) {
+            spdlog::error("Could not open the task log of device {}, its tasks won't survive a restart", _id);
+            return;
+        }
+
+        if (restored_count > 0) {
+            spdlog::info("Restored {} tasks of device {}", restored_count, _id);
+        }
+
+        if (dropped_count > 0) {
+            spdlog::warn("Dropped {} logged tasks of device {} which exceed its backlog", dropped_count, _id);
+        }
+
+        _task_log = std::move(task_log);
+        config.log_syncer->add(*_task_log);
+    }
+
+    auto Device::close() noexcept -> void {
+        _is_open = false;
+        notify_waiters();
+        notify_state_waiters();
+        _state_events.close_all();
+    }
+
+    auto Device::notify_waiters() noexcept -> void {
+        // Taking the lock makes sure a waiter can't miss us between checking and sleeping
+        _task_signal_mutex.lock();
+        _task_signal_mutex.unlock();
+        _task_signal.notify_all();
+    }
+
+    auto Device::wait_for_tasks(std::chrono::milliseconds timeout) noexcept -> void {
+        ++_waiter_count;
+
+        // Pairs with the fence in enqueue_task, either we see the task or it sees us
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::unique_lock lock(_task_signal_mutex);
+        _task_signal.wait_for(lock, timeout, [this] {
+            return _tasks.size() > 0 || !_is_open;
+        });
+        lock.unlock();
+
+        --_waiter_count;
+    }
+
+    auto Device::notify_state_waiters() noexcept -> void {
+        _state_signal_mutex.lock();
+        _state_signal_mutex.unlock();
+        _state_signal.notify_all();
+    }
+
+    auto Device::wait_for_state_change(kstd::u64 version, std::chrono::milliseconds timeout) noexcept -> void {
+        ++_state_waiter_count;
+
+        // Pairs with the fence in publish_change, same as for tasks
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::unique_lock lock(_state_signal_mutex);
+        _state_signal.wait_for(lock, timeout, [this, version] {
+            return _state.load().version != version || !_is_open;
+        });
+        lock.unlock();
+
+        --_state_waiter_count;
+    }
+
+    auto Device::dequeue_buffered(kstd::usize max_count) noexcept -> std::span<const dto::Task> {
+        // Shared by all devices, so it grows to the largest backlog a thread has seen
+        thread_local std::vector<dto::Task> buffer;
+
+        if (buffer.size() < _tasks.get_capacity()) {
+            buffer.resize(_tasks.get_capacity());
+        }
+
+        const auto task_count = dequeue_batch(max_count, buffer);
+        return std::span<const dto::Task>(buffer).first(task_count);
+    }
+
+    auto Device::dequeue_batch(kstd::usize max_count, std::span<dto::Task> out) noexcept -> kstd::usize {
+        out = out.first(std::min(max_count, out.size()));
+        kstd::usize count = 0;
+
+        if (_residence_tracker == nullptr) {
+            count = _tasks.try_pop_batch(out);
+        }
+        else {
+            thread_local std::vector<kstd::u64> enqueue_times;
+
+            if (enqueue_times.size() < out.size()) {
+                enqueue_times.resize(out.size());
+            }
+
+            count = _tasks.try_pop_batch(out, enqueue_times);
+            _residence_tracker->record(_id, out.first(count), std::span<const kstd::u64>(enqueue_times).first(count));
+        }
+
+        _total_processed_count += count;
+
+        if (count > 0) {
+            release_logged_tasks();
+        }
+
+        return count;
+    }
+
+    auto Device::set_state(const dto::DeviceState& state, dto::FieldMask mask) noexcept -> void {
+        static_cast<void>(apply_report(state, mask, std::nullopt));
+    }
+
+    auto Device::set_online(bool is_online) noexcept -> bool {
+        return apply_report({}, 0, is_online);
+    }
+
+    auto Device::apply_report(const dto::DeviceState& state, dto::FieldMask mask, std::optional<bool> is_online) noexcept -> bool {
+        auto previous_online = false;
+        auto is_changed = false;
+
+        // Controllers repeat their whole state, only fields that actually differ make a new version
+        _state.update([&](VersionedState& current) {
+            const auto changed = dto::diff_fields(current.state, state) & mask;
+            const auto is_online_changed = is_online && *is_online != current.is_online;
+            previous_online = current.is_online;
+
+            if (changed == 0 && !is_online_changed) {
+                return;
+            }
+
+            dto::assign_fields(current.state, state, changed);
+            ++current.version;
+            is_changed = true;
+
+            for (kstd::usize i = 0; i < current.field_versions.size(); ++i) {
+                if ((changed >> i & 1) != 0) {
+                    current.field_versions[i] = current.version;
+                }
+            }
+
+            if (is_online_changed) {
+                current.is_online = *is_online;
+                current.online_version = current.version;
+            }
+        });
+
+        if (is_changed) {
+            publish_change();
+        }
+
+        return previous_online;
+    }
+
+    auto Device::publish_change() noexcept -> void {
+        refresh_state_body();
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (_state_waiter_count.load(std::memory_order_relaxed) > 0) {
+            notify_state_waiters();
+        }
+
+        publish_state();
+    }
+
+    auto Device::refresh_state_body() noexcept -> void {
+        const auto state = _state.load();
+        auto current = _state_body.load(std::memory_order_acquire);
+
+        if (current != nullptr && current->version >= state.version) {
+            return;
+        }
+
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
+
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.write_fields(state.state);
+        writer.write_field("device", std::string_view(_id));
+        writer.write_field("is_online", state.is_online);
+        writer.write_field("version", state.version);
+        writer.write_key("timestamp");
+
+        const auto body = std::make_shared<const StateBody>(StateBody{state.version, std::string(buffer.data(), buffer.size())});
+
+        // Concurrent writers may finish out of order, an older body must never replace a newer one
+        while (current == nullptr || current->version < body->version) {
+            if (_state_body.compare_exchange_weak(current, body, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return;
+            }
+        }
+    }
+
+    auto Device::compile_state() noexcept -> nlohmann::json {
+        const auto versioned_state = _state.load();
+        auto state = nlohmann::json::object();
+        versioned_state.state.serialize(state);
+
+        state["device"] = _id;
+        state["is_online"] = versioned_state.is_online;
+        state["version"] = versioned_state.version;
+        state["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        return state;
+    }
+
+    auto Device::compile_delta(const VersionedState& state, kstd::u64 since_version) const noexcept -> nlohmann::json {
+        auto delta = nlohmann::json::object();
+        dto::serialize_fields(state.state, delta, state.get_changed_fields(since_version));
+
+        if (state.online_version > since_version) {
+            delta["is_online"] = state.is_online;
+        }
+
+        delta["device"] = _id;
+        delta["version"] = state.version;
+        delta["since_version"] = since_version;
+        delta["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        return delta;
+    }
+
+    auto Device::serialize_delta(const VersionedState& state, kstd::u64 since_version) const noexcept -> std::string {
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
+
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.write_fields(state.state, state.get_changed_fields(since_version));
+
+        if (state.online_version > since_version) {
+            writer.write_field("is_online", state.is_online);
+        }
+
+        writer.write_field("device", std::string_view(_id));
+        writer.write_field("version", state.version);
+        writer.write_field("since_version", since_version);
+        writer.write_field("timestamp", static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+        writer.end_object();
+        return {buffer.data(), buffer.size()};
+    }
+
+    auto StateBody::serialize() const noexcept -> std::string {
+        const fmt::format_int timestamp(static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+
+        std::string result;
+        result.reserve(prefix.size() + timestamp.size() + 1);
+        result.append(prefix);
+        result.append(timestamp.data(), timestamp.size());
+        result.push_back('}');
+        return result;
+    }
+
+    auto Device::serialize_state() const noexcept -> std::string {
+        return get_state_body()->serialize();
+    }
+
+    auto Device::publish_state() noexcept -> void {
+        if (_state_events.get_subscriber_count() == 0) {
+            return;
+        }
+
+        _state_events.publish(serialize_state());
+    }
+
+    auto Device::start_session(std::string_view password) noexcept -> void {
+        _session_password.set(password);
+        // Tokens and subscribers of the previous session lose access
+        _session_tokens.rotate();
+        _state_events.close_all();
+    }
+
+    auto Device::end_session() noexcept -> void {
+        _session_password.clear();
+        _session_tokens.rotate();
+        _state_events.close_all();
+    }
+
+    auto Device::sync_tasks() noexcept -> bool {
+        if (_task_log == nullptr) {
+            return true;
+        }
+
+        return _task_log->wait_synced(_task_log->get_written_sequence());
+    }
+
+    auto Device::try_open_task_stream() noexcept -> bool {
+        if (_task_stream_count.fetch_add(1) >= _max_subscribers) {
+            --_task_stream_count;
+            return false;
+        }
+
+        return true;
+    }
+
+    auto Device::close_task_stream() noexcept -> void {
+        --_task_stream_count;
+    }
+}
\ No newline at end of file
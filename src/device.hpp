@@ -0,0 +1,345 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <memory>
+#include <filesystem>
+#include <kstd/types.hpp>
+#include <nlohmann/json.hpp>
+
+#include "dto.hpp"
+#include "credential.hpp"
+#include "session_tokens.hpp"
+#include "json_writer.hpp"
+#include "task_queue.hpp"
+#include "task_log.hpp"
+#include "event_hub.hpp"
+#include "residence_tracker.hpp"
+#include "seqlock.hpp"
+
+namespace fox {
+    struct DeviceConfig final {
+        kstd::u32 backlog;
+        QueueConfig queue;
+        kstd::u32 max_subscribers;
+        kstd::u32 event_buffer_size;
+        std::chrono::milliseconds token_lifetime;
+        std::filesystem::path log_directory; // Parent of the per-device task logs, empty to keep tasks in memory only
+        TaskLogSyncer* log_syncer;
+        std::filesystem::path spill_directory; // Parent of the per-device spill files, empty to reject tasks once the backlog is full
+        ResidenceTracker* residence_tracker; // Null to skip tracking
+    };
+
+    /**
+     * Everything a client polls about a device, together with a version which grows with every change,
+     * so readers can tell whether anything changed.
+     */
+    struct VersionedState final {
+        dto::DeviceState state;
+        bool is_online;
+        kstd::u64 version; // Starts out at the creation time in microseconds, so versions don't repeat across restarts
+        std::array<kstd::u64, dto::field_count<dto::DeviceState>> field_versions; // The version each state field last changed in
+        kstd::u64 online_version;
+
+        /**
+         * @return The mask of the state fields which changed after the given version.
+         */
+        [[nodiscard]] inline auto get_changed_fields(kstd::u64 since_version) const noexcept -> dto::FieldMask {
+            dto::FieldMask mask = 0;
+
+            for (kstd::usize i = 0; i < field_versions.size(); ++i) {
+                if (field_versions[i] > since_version) {
+                    mask |= dto::FieldMask(1) << i;
+                }
+            }
+
+            return mask;
+        }
+    };
+
+    /**
+     * The JSON state of a device, serialized once per version and shared by every reader.
+     */
+    struct StateBody final {
+        kstd::u64 version;
+        std::string prefix; // Everything up to the value of the trailing timestamp field, which differs per response
+
+        /**
+         * @return The full JSON state, with the current timestamp spliced in.
+         */
+        [[nodiscard]] auto serialize() const noexcept -> std::string;
+    };
+
+    /**
+     * Everything the gateway tracks for a single controlled device:
+     * its task queue, last reported state, online flag and client session.
+     */
+    class Device final {
+        std::string _id;
+        kstd::u32 _backlog;
+        kstd::u32 _max_subscribers;
+
+        std::atomic_bool _is_open;
+        TaskQueue _tasks;
+        std::unique_ptr<TaskLog> _task_log;
+        ResidenceTracker* _residence_tracker;
+        std::mutex _task_signal_mutex;
+        std::condition_variable _task_signal;
+        std::atomic_uint32_t _waiter_count;
+        std::atomic_uint32_t _task_stream_count;
+
+        Credential _session_password;
+        SessionTokens _session_tokens;
+        EventHub _state_events;
+        kstd::u64 _base_version; // Versions before it belong to an earlier run, nobody can hold a delta base from there
+        SeqLock<VersionedState> _state; // Polled by every dashboard, so reads must not touch a shared lock
+        std::atomic<std::shared_ptr<const StateBody>> _state_body;
+        std::mutex _state_signal_mutex;
+        std::condition_variable _state_signal;
+        std::atomic_uint32_t _state_waiter_count;
+
+        std::atomic_size_t _total_task_count;
+        std::atomic_size_t _total_processed_count;
+
+        auto notify_waiters() noexcept -> void;
+
+        auto notify_state_waiters() noexcept -> void;
+
+        /**
+         * Publishes a new state body, wakes up everyone waiting for a change and pushes the state to all subscribers.
+         * Only called for updates which made a new version, so repeated identical reports don't flood subscribers.
+         */
+        auto publish_change() noexcept -> void;
+
+        auto publish_state() noexcept -> void;
+
+        /**
+         * Serializes the current state unless a body of the same or a newer version is already published.
+         */
+        auto refresh_state_body() noexcept -> void;
+
+        inline auto push_task(const dto::Task& task) noexcept -> bool {
+            if (_task_log == nullptr) {
+                return _tasks.try_push(task);
+            }
+
+            const auto lane = _tasks.get_lane(task.type);
+
+            return lane && _task_log->append(static_cast<kstd::u8>(*lane), task, [&](kstd::u64 sequence) {
+                return _tasks.try_push_to_lane(task, *lane, sequence);
+            });
+        }
+
+        inline auto release_logged_tasks() noexcept -> void {
+            if (_task_log == nullptr) {
+                return;
+            }
+
+            for (kstd::usize lane = 0; lane < QueueConfig::lane_count; ++lane) {
+                _task_log->consume(lane, _tasks.get_consumed_sequence(lane));
+            }
+        }
+
+        public:
+
+        Device(std::string id, const DeviceConfig& config) noexcept;
+
+        Device(const Device&) = delete;
+
+        auto operator =(const Device&) -> Device& = delete;
+
+        /**
+         * Wakes up everyone waiting on this device and ends its event streams, used on shutdown.
+         */
+        auto close() noexcept -> void;
+
+        auto wait_for_tasks(std::chrono::milliseconds timeout) noexcept -> void;
+
+        /**
+         * Waits until the state version differs from the given one, the device closes or the timeout passes.
+         */
+        auto wait_for_state_change(kstd::u64 version, std::chrono::milliseconds timeout) noexcept -> void;
+
+        [[nodiscard]] auto dequeue_buffered(kstd::usize max_count) noexcept -> std::span<const dto::Task>;
+
+        /**
+         * Applies the masked fields of the given state and bumps the version if any of them changed,
+         * readers never block the controller reporting a new state.
+         */
+        auto set_state(const dto::DeviceState& state, dto::FieldMask mask = dto::all_fields<dto::DeviceState>) noexcept -> void;
+
+        /**
+         * Applies the masked fields and, if given, the online flag as a single change,
+         * so readers never see one without the other.
+         * @return The previous online flag.
+         */
+        auto apply_report(const dto::DeviceState& state, dto::FieldMask mask, std::optional<bool> is_online) noexcept -> bool;
+
+        [[nodiscard]] auto compile_state() noexcept -> nlohmann::json;
+
+        /**
+         * @return True if a delta against the given version can be computed from the given state.
+         */
+        [[nodiscard]] inline auto is_delta_base(const VersionedState& state, kstd::u64 since_version) const noexcept -> bool {
+            return since_version >= _base_version && since_version <= state.version;
+        }
+
+        /**
+         * @return The JSON object of everything that changed between since_version and the given state,
+         * which has to be a delta base.
+         */
+        [[nodiscard]] auto compile_delta(const VersionedState& state, kstd::u64 since_version) const noexcept -> nlohmann::json;
+
+        [[nodiscard]] auto serialize_delta(const VersionedState& state, kstd::u64 since_version) const noexcept -> std::string;
+
+        /**
+         * @return The JSON state with the current timestamp spliced into the cached body, without serializing anything.
+         */
+        [[nodiscard]] auto serialize_state() const noexcept -> std::string;
+
+        /**
+         * Starts a new client session, which revokes all tokens and event streams of the previous one.
+         */
+        auto start_session(std::string_view password) noexcept -> void;
+
+        auto end_session() noexcept -> void;
+
+        /**
+         * Reserves one of the limited task streams of this device.
+         */
+        [[nodiscard]] auto try_open_task_stream() noexcept -> bool;
+
+        auto close_task_stream() noexcept -> void;
+
+        /**
+         * Blocks until every task enqueued so far survives a restart, returns right away without a task log.
+         * @return False if the task log could not be flushed.
+         */
+        [[nodiscard]] auto sync_tasks() noexcept -> bool;
+
+        inline auto enqueue_task(dto::Task task) noexcept -> bool {
+            if (!push_task(task)) {
+                return false;
+            }
+
+            ++_total_task_count;
+
+            // Pairs with the fence in wait_for_tasks, either we see the waiter or it sees our task
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (_waiter_count.load(std::memory_order_relaxed) > 0) {
+                notify_waiters();
+            }
+
+            return true;
+        }
+
+        /**
+         * Hands out up to max_count tasks, recording how long each of them was queued.
+         */
+        auto dequeue_batch(kstd::usize max_count, std::span<dto::Task> out) noexcept -> kstd::usize;
+
+        inline auto dequeue_task() noexcept -> std::optional<dto::Task> {
+            dto::Task task{};
+
+            if (dequeue_batch(1, {&task, 1}) == 0) {
+                return std::nullopt;
+            }
+
+            return {task};
+        }
+
+        inline auto clear_tasks() noexcept -> kstd::usize {
+            const auto count = _tasks.clear();
+            release_logged_tasks();
+            return count;
+        }
+
+        [[nodiscard]] inline auto get_state() const noexcept -> dto::DeviceState {
+            return _state.load().state;
+        }
+
+        [[nodiscard]] inline auto get_versioned_state() const noexcept -> VersionedState {
+            return _state.load();
+        }
+
+        [[nodiscard]] inline auto get_tasks() const noexcept -> const TaskQueue& {
+            return _tasks;
+        }
+
+        /**
+         * Bumps the state version if the flag changes.
+         * @return The previous online flag.
+         */
+        auto set_online(bool is_online) noexcept -> bool;
+
+        [[nodiscard]] inline auto is_online() const noexcept -> bool {
+            return _state.load().is_online;
+        }
+
+        [[nodiscard]] inline auto get_state_body() const noexcept -> std::shared_ptr<const StateBody> {
+            return _state_body.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] inline auto is_open() const noexcept -> bool {
+            return _is_open;
+        }
+
+        [[nodiscard]] inline auto has_session() const noexcept -> bool {
+            return _session_password.is_set();
+        }
+
+        [[nodiscard]] inline auto check_session_password(std::string_view password) const noexcept -> bool {
+            return _session_password.matches(password);
+        }
+
+        [[nodiscard]] inline auto check_session_token(std::string_view token) const noexcept -> bool {
+            return _session_tokens.verify(token);
+        }
+
+        [[nodiscard]] inline auto issue_session_token() noexcept -> std::string {
+            return _session_tokens.issue();
+        }
+
+        [[nodiscard]] inline auto get_token_lifetime() const noexcept -> std::chrono::milliseconds {
+            return _session_tokens.get_lifetime();
+        }
+
+        [[nodiscard]] inline auto get_state_events() noexcept -> EventHub& {
+            return _state_events;
+        }
+
+        [[nodiscard]] inline auto get_id() const noexcept -> const std::string& {
+            return _id;
+        }
+
+        [[nodiscard]] inline auto get_backlog() const noexcept -> kstd::u32 {
+            return _backlog;
+        }
+
+        [[nodiscard]] inline auto get_task_count() const noexcept -> kstd::usize {
+            return _tasks.size();
+        }
+
+        [[nodiscard]] inline auto get_total_task_count() const noexcept -> kstd::usize {
+            return _total_task_count;
+        }
+
+        [[nodiscard]] inline auto get_total_processed_count() const noexcept -> kstd::usize {
+            return _total_processed_count;
+        }
+    };
+}
\ No newline at end of file
@@ -5,19 +5,177 @@
 
 #pragma once
 
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <kstd/types.hpp>
 #include <nlohmann/json.hpp>
 
-#define FOX_JSON_SET(j, x) j[#x] = x
-#define FOX_JSON_GET(j, x) x = j[#x]
+#define FOX_FIELD(t, x) ::fox::dto::Field<t, decltype(t::x)>{#x, &t::x}
 
 namespace fox::dto {
+    /**
+     * Describes a single serialized member of a DTO.
+     * Every DTO lists its members in a static fields() function,
+     * which drives both the DOM based and the direct JSON serialization.
+     */
+    template<typename T, typename M>
+    struct Field final {
+        std::string_view name;
+        M T::* member;
+    };
+
+    template<typename T, typename F>
+    constexpr auto for_each_field(T& value, F&& function) -> void {
+        std::apply([&value, &function](const auto& ... field) {
+            (function(field.name, value.*(field.member)), ...);
+        }, std::remove_const_t<T>::fields());
+    }
+
+    /**
+     * One bit per field of a DTO, in the order of its fields() list.
+     */
+    using FieldMask = kstd::u32;
+
+    template<typename T>
+    static constexpr kstd::usize field_count = std::tuple_size_v<decltype(T::fields())>;
+
+    template<typename T>
+    static constexpr FieldMask all_fields = (FieldMask(1) << field_count<T>) - 1;
+
+    /**
+     * Like for_each_field, but also passes the index of every field, which is its bit in a FieldMask.
+     */
+    template<typename T, typename F>
+    constexpr auto for_each_field_indexed(T& value, F&& function) -> void {
+        std::apply([&value, &function](const auto& ... field) {
+            kstd::usize index = 0;
+            (function(index++, field.name, value.*(field.member)), ...);
+        }, std::remove_const_t<T>::fields());
+    }
+
+    template<typename T>
+    inline auto serialize_fields(const T& value, nlohmann::json& json) noexcept -> void {
+        for_each_field(value, [&json](std::string_view name, const auto& member) {
+            json[name] = member;
+        });
+    }
+
+    template<typename T>
+    inline auto serialize_fields(const T& value, nlohmann::json& json, FieldMask mask) noexcept -> void {
+        for_each_field_indexed(value, [&json, mask](kstd::usize index, std::string_view name, const auto& member) {
+            if ((mask >> index & 1) != 0) {
+                json[name] = member;
+            }
+        });
+    }
+
+    template<typename T>
+    inline auto deserialize_fields(T& value, const nlohmann::json& json) -> void {
+        for_each_field(value, [&json](std::string_view name, auto& member) {
+            json.at(name).get_to(member);
+        });
+    }
+
+    /**
+     * Reads only the fields present in the given JSON and leaves all others alone.
+     * @return The mask of the fields which were read.
+     */
+    template<typename T>
+    inline auto deserialize_present_fields(T& value, const nlohmann::json& json) -> FieldMask {
+        FieldMask mask = 0;
+
+        for_each_field_indexed(value, [&json, &mask](kstd::usize index, std::string_view name, auto& member) {
+            const auto entry = json.find(name);
+
+            if (entry != json.end()) {
+                entry->get_to(member);
+                mask |= FieldMask(1) << index;
+            }
+        });
+
+        return mask;
+    }
+
+    /**
+     * @return The mask of the fields which differ between both values.
+     */
+    template<typename T>
+    inline auto diff_fields(const T& lhs, const T& rhs) noexcept -> FieldMask {
+        FieldMask mask = 0;
+
+        std::apply([&lhs, &rhs, &mask](const auto& ... field) {
+            kstd::usize index = 0;
+
+            const auto compare = [&](const auto& current) {
+                if (lhs.*(current.member) != rhs.*(current.member)) {
+                    mask |= FieldMask(1) << index;
+                }
+
+                ++index;
+            };
+
+            (compare(field), ...);
+        }, T::fields());
+
+        return mask;
+    }
+
+    /**
+     * Copies the masked fields of source into target.
+     */
+    template<typename T>
+    inline auto assign_fields(T& target, const T& source, FieldMask mask) noexcept -> void {
+        std::apply([&target, &source, mask](const auto& ... field) {
+            kstd::usize index = 0;
+
+            const auto assign = [&](const auto& current) {
+                if ((mask >> index++ & 1) != 0) {
+                    target.*(current.member) = source.*(current.member);
+                }
+            };
+
+            (assign(field), ...);
+        }, T::fields());
+    }
+
+    // Little endian helpers for the packed wire format
+    inline auto pack_u32(std::string& out, kstd::u32 value) noexcept -> void {
+        out.push_back(static_cast<char>(value & 0xFF));
+        out.push_back(static_cast<char>((value >> 8) & 0xFF));
+        out.push_back(static_cast<char>((value >> 16) & 0xFF));
+        out.push_back(static_cast<char>((value >> 24) & 0xFF));
+    }
+
+    inline auto pack_u64(std::string& out, kstd::u64 value) noexcept -> void {
+        pack_u32(out, static_cast<kstd::u32>(value));
+        pack_u32(out, static_cast<kstd::u32>(value >> 32));
+    }
+
+    inline auto unpack_u16(const char* data) noexcept -> kstd::u16 {
+        const auto* bytes = reinterpret_cast<const kstd::u8*>(data);
+        return static_cast<kstd::u16>(bytes[0] | (bytes[1] << 8));
+    }
+
+    inline auto unpack_u32(const char* data) noexcept -> kstd::u32 {
+        const auto* bytes = reinterpret_cast<const kstd::u8*>(data);
+        return static_cast<kstd::u32>(bytes[0])
+               | (static_cast<kstd::u32>(bytes[1]) << 8)
+               | (static_cast<kstd::u32>(bytes[2]) << 16)
+               | (static_cast<kstd::u32>(bytes[3]) << 24);
+    }
+
     enum class TaskType : kstd::u8 {
         POWER,
         SPEED,
         MODE
     };
 
+    static constexpr kstd::usize task_type_count = 3;
+
     enum class Mode : kstd::u8 {
         DEFAULT
     };
@@ -26,14 +184,16 @@ namespace fox::dto {
         TaskType type;
         bool is_on;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, type);
-            FOX_JSON_SET(json, is_on);
+        static constexpr auto fields() noexcept {
+            return std::make_tuple(FOX_FIELD(PowerTask, type), FOX_FIELD(PowerTask, is_on));
+        }
+
+        inline auto serialize(nlohmann::json& json) const noexcept -> void {
+            serialize_fields(*this, json);
         }
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, type);
-            FOX_JSON_GET(json, is_on);
+        inline auto deserialize(const nlohmann::json& json) -> void {
+            deserialize_fields(*this, json);
         }
     };
 
@@ -41,14 +201,16 @@ namespace fox::dto {
         TaskType type;
         kstd::i32 speed;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, type);
-            FOX_JSON_SET(json, speed);
+        static constexpr auto fields() noexcept {
+            return std::make_tuple(FOX_FIELD(SpeedTask, type), FOX_FIELD(SpeedTask, speed));
+        }
+
+        inline auto serialize(nlohmann::json& json) const noexcept -> void {
+            serialize_fields(*this, json);
         }
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, type);
-            FOX_JSON_GET(json, speed);
+        inline auto deserialize(const nlohmann::json& json) -> void {
+            deserialize_fields(*this, json);
         }
     };
 
@@ -56,24 +218,70 @@ namespace fox::dto {
         TaskType type;
         Mode mode;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, type);
-            FOX_JSON_SET(json, mode);
+        static constexpr auto fields() noexcept {
+            return std::make_tuple(FOX_FIELD(ModeTask, type), FOX_FIELD(ModeTask, mode));
+        }
+
+        inline auto serialize(nlohmann::json& json) const noexcept -> void {
+            serialize_fields(*this, json);
         }
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, type);
-            FOX_JSON_GET(json, mode);
+        inline auto deserialize(const nlohmann::json& json) -> void {
+            deserialize_fields(*this, json);
         }
     };
 
     union Task {
+        // [type: u8][value: u32], where value is is_on, speed or mode depending on the type
+        static constexpr kstd::usize packed_size = 5;
+
         TaskType type;
         PowerTask power;
         SpeedTask speed;
         ModeTask mode;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
+        /**
+         * @return The single value the task carries, is_on, speed or mode depending on its type.
+         */
+        [[nodiscard]] inline auto get_value() const noexcept -> kstd::u32 {
+            switch (type) {
+                case TaskType::POWER:
+                    return power.is_on ? 1 : 0;
+                case TaskType::SPEED:
+                    return static_cast<kstd::u32>(speed.speed);
+                case TaskType::MODE:
+                    return static_cast<kstd::u32>(mode.mode);
+            }
+
+            return 0;
+        }
+
+        inline auto set_value(TaskType new_type, kstd::u32 value) noexcept -> bool {
+            switch (new_type) {
+                case TaskType::POWER:
+                    power = {TaskType::POWER, value != 0};
+                    return true;
+                case TaskType::SPEED:
+                    speed = {TaskType::SPEED, static_cast<kstd::i32>(value)};
+                    return true;
+                case TaskType::MODE:
+                    mode = {TaskType::MODE, static_cast<Mode>(value)};
+                    return true;
+            }
+
+            return false;
+        }
+
+        inline auto pack(std::string& out) const noexcept -> void {
+            out.push_back(static_cast<char>(type));
+            pack_u32(out, get_value());
+        }
+
+        inline auto unpack(const char* data) noexcept -> bool {
+            return set_value(static_cast<TaskType>(data[0]), unpack_u32(data + 1));
+        }
+
+        inline auto serialize(nlohmann::json& json) const noexcept -> void {
             switch (type) {
                 case TaskType::POWER:
                     power.serialize(json);
@@ -87,8 +295,8 @@ namespace fox::dto {
             }
         }
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            switch (static_cast<TaskType>(json["type"])) {
+        inline auto deserialize(const nlohmann::json& json) -> void {
+            switch (static_cast<TaskType>(json.at("type"))) {
                 case TaskType::POWER:
                     power.deserialize(json);
                     break;
@@ -98,31 +306,117 @@ namespace fox::dto {
                 case TaskType::MODE:
                     mode.deserialize(json);
                     break;
+                default: // Left zeroed, it would pass for a power off task
+                    throw std::out_of_range("Unknown task type");
             }
         }
     };
 
     struct DeviceState final {
+        // [flags: u8][target_speed: u32][actual_speed: u32][mode: u8], flags hold accepts_commands and is_on
+        static constexpr kstd::usize packed_size = 10;
+        // Partial updates start with [0x80 | mask: u8] instead, followed by the masked fields in order, booleans as u8
+        static constexpr kstd::u8 packed_partial_flag = 0x80;
+
         bool accepts_commands;
         bool is_on;
         kstd::u32 target_speed;
         kstd::u32 actual_speed;
         Mode mode;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, accepts_commands);
-            FOX_JSON_SET(json, is_on);
-            FOX_JSON_SET(json, target_speed);
-            FOX_JSON_SET(json, actual_speed);
-            FOX_JSON_SET(json, mode);
+        static constexpr auto fields() noexcept {
+            return std::make_tuple(
+                    FOX_FIELD(DeviceState, accepts_commands),
+                    FOX_FIELD(DeviceState, is_on),
+                    FOX_FIELD(DeviceState, target_speed),
+                    FOX_FIELD(DeviceState, actual_speed),
+                    FOX_FIELD(DeviceState, mode));
         }
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, accepts_commands);
-            FOX_JSON_GET(json, is_on);
-            FOX_JSON_GET(json, target_speed);
-            FOX_JSON_GET(json, actual_speed);
-            FOX_JSON_GET(json, mode);
+        inline auto serialize(nlohmann::json& json) const noexcept -> void {
+            serialize_fields(*this, json);
+        }
+
+        inline auto deserialize(const nlohmann::json& json) -> void {
+            deserialize_fields(*this, json);
+        }
+
+        /**
+         * @return The mask of the fields present in the given JSON, which are the only ones read.
+         */
+        inline auto deserialize_partial(const nlohmann::json& json) -> FieldMask {
+            return deserialize_present_fields(*this, json);
+        }
+
+        inline auto pack(std::string& out) const noexcept -> void {
+            out.push_back(static_cast<char>((accepts_commands ? 0x01 : 0x00) | (is_on ? 0x02 : 0x00)));
+            pack_u32(out, target_speed);
+            pack_u32(out, actual_speed);
+            out.push_back(static_cast<char>(mode));
+        }
+
+        inline auto unpack(const char* data) noexcept -> void {
+            const auto flags = static_cast<kstd::u8>(data[0]);
+            accepts_commands = (flags & 0x01) != 0;
+            is_on = (flags & 0x02) != 0;
+            target_speed = unpack_u32(data + 1);
+            actual_speed = unpack_u32(data + 5);
+            mode = static_cast<Mode>(data[9]);
+        }
+
+        [[nodiscard]] static inline auto is_packed_partial(std::string_view data) noexcept -> bool {
+            return !data.empty() && (static_cast<kstd::u8>(data[0]) & packed_partial_flag) != 0;
+        }
+
+        /**
+         * Reads a partial update as described next to packed_size.
+         * @return The mask of the fields read, or nothing if the data doesn't match its mask.
+         */
+        inline auto unpack_partial(std::string_view data) noexcept -> std::optional<FieldMask> {
+            if (!is_packed_partial(data)) {
+                return std::nullopt;
+            }
+
+            const auto mask = static_cast<FieldMask>(static_cast<kstd::u8>(data[0]) & ~packed_partial_flag);
+
+            if ((mask & ~all_fields<DeviceState>) != 0) {
+                return std::nullopt;
+            }
+
+            kstd::usize offset = 1;
+            auto is_valid = true;
+
+            for_each_field_indexed(*this, [&](kstd::usize index, std::string_view, auto& member) {
+                if (!is_valid || (mask >> index & 1) == 0) {
+                    return;
+                }
+
+                using Member = std::remove_reference_t<decltype(member)>;
+                constexpr kstd::usize size = std::is_same_v<Member, kstd::u32> ? 4 : 1;
+
+                if (data.size() < offset + size) {
+                    is_valid = false;
+                    return;
+                }
+
+                if constexpr (std::is_same_v<Member, kstd::u32>) {
+                    member = unpack_u32(data.data() + offset);
+                }
+                else if constexpr (std::is_same_v<Member, bool>) {
+                    member = data[offset] != 0;
+                }
+                else {
+                    member = static_cast<Member>(data[offset]);
+                }
+
+                offset += size;
+            });
+
+            if (!is_valid || offset != data.size()) {
+                return std::nullopt;
+            }
+
+            return mask;
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,280 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include "enqueue_parser.hpp"
+
+namespace fox {
+    EnqueueParser::EnqueueParser() noexcept:
+            _depth(0),
+            _skip_depth(0),
+            _field(Field::NONE),
+            _is_object(false),
+            _has_password(false),
+            _has_tasks(false),
+            _is_tasks_array(false),
+            _task_count(0),
+            _task_fields(0),
+            _type(0),
+            _is_on(false),
+            _speed(0),
+            _mode(0) {
+    }
+
+    auto EnqueueParser::parse(const std::string& body, nlohmann::json::input_format_t format) noexcept -> bool {
+        _depth = 0;
+        _skip_depth = 0;
+        _field = Field::NONE;
+        _is_object = false;
+        _has_password = false;
+        _has_tasks = false;
+        _is_tasks_array = false;
+        _password.clear();
+        _message_type.clear();
+        _tasks.clear();
+        _task_count = 0;
+
+        try {
+            return nlohmann::json::sax_parse(body, this, format);
+        }
+        catch (const std::exception& error) {
+            return false;
+        }
+    }
+
+    auto EnqueueParser::begin_skip() noexcept -> bool {
+        _skip_depth = 1;
+        _field = Field::NONE;
+        return true;
+    }
+
+    auto EnqueueParser::on_scalar() noexcept -> bool {
+        if (_skip_depth > 0) {
+            return true;
+        }
+
+        if (_depth == 1 && _field == Field::TASKS) {
+            _has_tasks = true;
+        }
+        else if (_depth == 2) {
+            ++_task_count; // Not an object, but still part of the list
+        }
+
+        _field = Field::NONE;
+        return true;
+    }
+
+    auto EnqueueParser::on_number(kstd::i64 value) noexcept -> bool {
+        if (_skip_depth == 0 && _depth == 3) {
+            switch (_field) {
+                case Field::TYPE:
+                    _type = value;
+                    break;
+                case Field::SPEED:
+                    _speed = value;
+                    break;
+                case Field::MODE:
+                    _mode = value;
+                    break;
+                default:
+                    return on_scalar();
+            }
+
+            _task_fields |= 1U << static_cast<kstd::u8>(_field);
+        }
+
+        return on_scalar();
+    }
+
+    auto EnqueueParser::finish_task() noexcept -> void {
+        if (!has_task_field(Field::TYPE) || _type < 0) {
+            return;
+        }
+
+        dto::Task task{};
+
+        switch (static_cast<dto::TaskType>(_type)) {
+            case dto::TaskType::POWER:
+                if (!has_task_field(Field::IS_ON)) {
+                    return;
+                }
+                task.power = {dto::TaskType::POWER, _is_on};
+                break;
+            case dto::TaskType::SPEED:
+                if (!has_task_field(Field::SPEED)) {
+                    return;
+                }
+                task.speed = {dto::TaskType::SPEED, static_cast<kstd::i32>(_speed)};
+                break;
+            case dto::TaskType::MODE:
+                if (!has_task_field(Field::MODE)) {
+                    return;
+                }
+                task.mode = {dto::TaskType::MODE, static_cast<dto::Mode>(_mode)};
+                break;
+            default:
+                return;
+        }
+
+        _tasks.push_back(task);
+    }
+
+    auto EnqueueParser::null() noexcept -> bool {
+        return on_scalar();
+    }
+
+    auto EnqueueParser::boolean(bool value) noexcept -> bool {
+        if (_skip_depth == 0 && _depth == 3 && _field == Field::IS_ON) {
+            _is_on = value;
+            _task_fields |= 1U << static_cast<kstd::u8>(Field::IS_ON);
+        }
+
+        return on_scalar();
+    }
+
+    auto EnqueueParser::number_integer(number_integer_t value) noexcept -> bool {
+        return on_number(value);
+    }
+
+    auto EnqueueParser::number_unsigned(number_unsigned_t value) noexcept -> bool {
+        return on_number(static_cast<kstd::i64>(value));
+    }
+
+    auto EnqueueParser::number_float(number_float_t value, const string_t& raw) noexcept -> bool {
+        return on_scalar();
+    }
+
+    auto EnqueueParser::string(string_t& value) noexcept -> bool {
+        if (_skip_depth == 0 && _depth == 1) {
+            if (_field == Field::PASSWORD) {
+                _has_password = true;
+                _password.assign(value);
+            }
+            else if (_field == Field::MESSAGE_TYPE) {
+                _message_type.assign(value);
+            }
+        }
+
+        return on_scalar();
+    }
+
+    auto EnqueueParser::binary(binary_t& value) noexcept -> bool {
+        return on_scalar();
+    }
+
+    auto EnqueueParser::start_object(std::size_t size) noexcept -> bool {
+        if (_skip_depth > 0) {
+            ++_skip_depth;
+            return true;
+        }
+
+        switch (_depth) {
+            case 0:
+                _is_object = true;
+                _depth = 1;
+                return true;
+            case 1:
+                _has_tasks = _has_tasks || _field == Field::TASKS;
+                return begin_skip();
+            case 2:
+                ++_task_count;
+                _task_fields = 0;
+                _field = Field::NONE;
+                _depth = 3;
+                return true;
+            default:
+                return begin_skip();
+        }
+    }
+
+    auto EnqueueParser::key(string_t& value) noexcept -> bool {
+        if (_skip_depth > 0) {
+            return true;
+        }
+
+        _field = Field::NONE;
+
+        if (_depth == 1) {
+            if (value == "password") {
+                _field = Field::PASSWORD;
+            }
+            else if (value == "tasks") {
+                _field = Field::TASKS;
+            }
+            else if (value == "type") {
+                _field = Field::MESSAGE_TYPE;
+            }
+        }
+        else if (_depth == 3) {
+            if (value == "type") {
+                _field = Field::TYPE;
+            }
+            else if (value == "is_on") {
+                _field = Field::IS_ON;
+            }
+            else if (value == "speed") {
+                _field = Field::SPEED;
+            }
+            else if (value == "mode") {
+                _field = Field::MODE;
+            }
+        }
+
+        return true;
+    }
+
+    auto EnqueueParser::end_object() noexcept -> bool {
+        if (_skip_depth > 0) {
+            --_skip_depth;
+            return true;
+        }
+
+        if (_depth == 3) {
+            finish_task();
+            _depth = 2;
+        }
+        else {
+            _depth = 0;
+        }
+
+        _field = Field::NONE;
+        return true;
+    }
+
+    auto EnqueueParser::start_array(std::size_t size) noexcept -> bool {
+        if (_skip_depth > 0) {
+            ++_skip_depth;
+            return true;
+        }
+
+        if (_depth == 1 && _field == Field::TASKS) {
+            _has_tasks = true;
+            _is_tasks_array = true;
+            _field = Field::NONE;
+            _depth = 2;
+            return true;
+        }
+
+        if (_depth == 2) {
+            ++_task_count;
+        }
+
+        return begin_skip();
+    }
+
+    auto EnqueueParser::end_array() noexcept -> bool {
+        if (_skip_depth > 0) {
+            --_skip_depth;
+            return true;
+        }
+
+        _depth = 1;
+        _field = Field::NONE;
+        return true;
+    }
+
+    auto EnqueueParser::parse_error(std::size_t position, const std::string& token, const nlohmann::detail::exception& error) noexcept -> bool {
+        return false;
+    }
+}
\ No newline at end of file
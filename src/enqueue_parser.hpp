@@ -0,0 +1,152 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <kstd/types.hpp>
+#include <nlohmann/json.hpp>
+
+#include "dto.hpp"
+
+namespace fox {
+    /**
+     * Streaming decoder for /enqueue request bodies and WebSocket messages.
+     * Tasks are decoded straight from the SAX events of the bundled parser,
+     * without ever building a DOM. Works on JSON, CBOR and MessagePack input.
+     * Instances are meant to be reused, so the task buffer keeps its capacity.
+     */
+    class EnqueueParser final {
+        enum class Field : kstd::u8 {
+            NONE,
+            PASSWORD,
+            TASKS,
+            MESSAGE_TYPE,
+            TYPE,
+            IS_ON,
+            SPEED,
+            MODE
+        };
+
+        // Container depth, 1 is the root object, 2 the tasks array and 3 a single task
+        kstd::usize _depth;
+        // Nesting level of a value we don't care about and are skipping over
+        kstd::usize _skip_depth;
+        Field _field;
+
+        bool _is_object;
+        bool _has_password;
+        bool _has_tasks;
+        bool _is_tasks_array;
+        std::string _password;
+        std::string _message_type;
+        std::vector<dto::Task> _tasks;
+        kstd::usize _task_count;
+
+        // Fields of the task currently being decoded, _task_fields is a bit mask of the fields seen so far
+        kstd::u8 _task_fields;
+        kstd::i64 _type;
+        bool _is_on;
+        kstd::i64 _speed;
+        kstd::i64 _mode;
+
+        [[nodiscard]] inline auto has_task_field(Field field) const noexcept -> bool {
+            return (_task_fields & (1U << static_cast<kstd::u8>(field))) != 0;
+        }
+
+        auto begin_skip() noexcept -> bool;
+
+        auto on_scalar() noexcept -> bool;
+
+        auto on_number(kstd::i64 value) noexcept -> bool;
+
+        auto finish_task() noexcept -> void;
+
+        public:
+
+        using number_integer_t = nlohmann::json::number_integer_t;
+        using number_unsigned_t = nlohmann::json::number_unsigned_t;
+        using number_float_t = nlohmann::json::number_float_t;
+        using string_t = nlohmann::json::string_t;
+        using binary_t = nlohmann::json::binary_t;
+
+        EnqueueParser() noexcept;
+
+        /**
+         * @return False if the body is not well-formed in the given format.
+         */
+        [[nodiscard]] auto parse(const std::string& body, nlohmann::json::input_format_t format) noexcept -> bool;
+
+        [[nodiscard]] inline auto is_object() const noexcept -> bool {
+            return _is_object;
+        }
+
+        [[nodiscard]] inline auto has_password() const noexcept -> bool {
+            return _has_password;
+        }
+
+        [[nodiscard]] inline auto get_password() const noexcept -> const std::string& {
+            return _password;
+        }
+
+        /**
+         * @return The top-level "type" string WebSocket messages are dispatched on, empty if there is none.
+         */
+        [[nodiscard]] inline auto get_message_type() const noexcept -> const std::string& {
+            return _message_type;
+        }
+
+        [[nodiscard]] inline auto has_tasks() const noexcept -> bool {
+            return _has_tasks;
+        }
+
+        [[nodiscard]] inline auto is_tasks_array() const noexcept -> bool {
+            return _is_tasks_array;
+        }
+
+        /**
+         * @return All well-formed tasks of the request, malformed entries are left out.
+         */
+        [[nodiscard]] inline auto get_tasks() const noexcept -> const std::vector<dto::Task>& {
+            return _tasks;
+        }
+
+        /**
+         * @return The number of entries in the tasks array, including malformed ones.
+         */
+        [[nodiscard]] inline auto get_task_count() const noexcept -> kstd::usize {
+            return _task_count;
+        }
+
+        // SAX interface
+
+        auto null() noexcept -> bool;
+
+        auto boolean(bool value) noexcept -> bool;
+
+        auto number_integer(number_integer_t value) noexcept -> bool;
+
+        auto number_unsigned(number_unsigned_t value) noexcept -> bool;
+
+        auto number_float(number_float_t value, const string_t& raw) noexcept -> bool;
+
+        auto string(string_t& value) noexcept -> bool;
+
+        auto binary(binary_t& value) noexcept -> bool;
+
+        auto start_object(std::size_t size) noexcept -> bool;
+
+        auto key(string_t& value) noexcept -> bool;
+
+        auto end_object() noexcept -> bool;
+
+        auto start_array(std::size_t size) noexcept -> bool;
+
+        auto end_array() noexcept -> bool;
+
+        auto parse_error(std::size_t position, const std::string& token, const nlohmann::detail::exception& error) noexcept -> bool;
+    };
+}
\ No newline at end of file
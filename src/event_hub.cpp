@@ -0,0 +1,109 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include "event_hub.hpp"
+
+namespace fox {
+    EventStream::EventStream(kstd::usize capacity) noexcept:
+            _capacity(capacity),
+            _is_dropped(false),
+            _is_closed(false) {
+    }
+
+    auto EventStream::push(const std::string& event) noexcept -> bool {
+        std::unique_lock lock(_mutex);
+
+        if (_is_dropped || _is_closed) {
+            return false;
+        }
+
+        if (_events.size() >= _capacity) { // Slow consumer, cut it loose
+            _events.clear();
+            _is_dropped = true;
+            lock.unlock();
+            _signal.notify_all();
+            return false;
+        }
+
+        _events.push_back(event);
+        lock.unlock();
+        _signal.notify_one();
+        return true;
+    }
+
+    auto EventStream::wait_pop(std::chrono::milliseconds timeout) noexcept -> std::optional<std::string> {
+        std::unique_lock lock(_mutex);
+
+        _signal.wait_for(lock, timeout, [this] {
+            return !_events.empty() || _is_dropped || _is_closed;
+        });
+
+        if (_is_dropped || _is_closed) {
+            return std::nullopt;
+        }
+
+        if (_events.empty()) {
+            return {std::string()};
+        }
+
+        auto event = std::move(_events.front());
+        _events.pop_front();
+        return {std::move(event)};
+    }
+
+    auto EventStream::close() noexcept -> void {
+        _mutex.lock();
+        _is_closed = true;
+        _mutex.unlock();
+        _signal.notify_all();
+    }
+
+    EventHub::EventHub(kstd::usize max_streams, kstd::usize buffer_size) noexcept:
+            _max_streams(max_streams),
+            _buffer_size(buffer_size) {
+    }
+
+    auto EventHub::subscribe() noexcept -> std::shared_ptr<EventStream> {
+        std::lock_guard lock(_mutex);
+
+        if (_streams.size() >= _max_streams) {
+            return nullptr;
+        }
+
+        auto stream = std::make_shared<EventStream>(_buffer_size);
+        _streams.push_back(stream);
+        return stream;
+    }
+
+    auto EventHub::unsubscribe(const std::shared_ptr<EventStream>& stream) noexcept -> void {
+        std::lock_guard lock(_mutex);
+        std::erase(_streams, stream);
+    }
+
+    auto EventHub::publish(const std::string& event) noexcept -> void {
+        std::lock_guard lock(_mutex);
+
+        for (const auto& stream: _streams) {
+            if (!stream->push(event)) {
+                spdlog::debug("Dropped slow event subscriber");
+            }
+        }
+    }
+
+    auto EventHub::close_all() noexcept -> void {
+        std::lock_guard lock(_mutex);
+
+        for (const auto& stream: _streams) {
+            stream->close();
+        }
+    }
+
+    auto EventHub::get_subscriber_count() noexcept -> kstd::usize {
+        std::lock_guard lock(_mutex);
+        return _streams.size();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <string>
+#include <optional>
+#include <chrono>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * A single subscriber of an event hub with a bounded event buffer.
+     * Once the buffer overflows, the subscriber is dropped instead of
+     * being allowed to hold up the publisher or grow without bounds.
+     */
+    class EventStream final {
+        std::mutex _mutex;
+        std::condition_variable _signal;
+        std::deque<std::string> _events;
+        kstd::usize _capacity;
+        bool _is_dropped;
+        bool _is_closed;
+
+        public:
+
+        explicit EventStream(kstd::usize capacity) noexcept;
+
+        auto push(const std::string& event) noexcept -> bool;
+
+        /**
+         * Waits for the next event or the given timeout.
+         * @return The next event, an empty string on timeout or std::nullopt if the stream has been closed or dropped.
+         */
+        [[nodiscard]] auto wait_pop(std::chrono::milliseconds timeout) noexcept -> std::optional<std::string>;
+
+        auto close() noexcept -> void;
+    };
+
+    class EventHub final {
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<EventStream>> _streams;
+        kstd::usize _max_streams;
+        kstd::usize _buffer_size;
+
+        public:
+
+        EventHub(kstd::usize max_streams, kstd::usize buffer_size) noexcept;
+
+        /**
+         * @return A new subscriber stream, or nullptr if the hub is at capacity.
+         */
+        [[nodiscard]] auto subscribe() noexcept -> std::shared_ptr<EventStream>;
+
+        auto unsubscribe(const std::shared_ptr<EventStream>& stream) noexcept -> void;
+
+        auto publish(const std::string& event) noexcept -> void;
+
+        auto close_all() noexcept -> void;
+
+        [[nodiscard]] auto get_subscriber_count() noexcept -> kstd::usize;
+    };
+}
\ No newline at end of file
@@ -4,56 +4,250 @@
  */
 
 #include <ctime>
+#include <charconv>
 #include <sstream>
+#include <vector>
 #include <httplib.h>
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include "gateway.hpp"
 
 #define FOX_HTML_MIME_TYPE "text/html"
-#define FOX_JSON_MIME_TYPE "application/json"
+#define FOX_EVENT_STREAM_MIME_TYPE "text/event-stream"
+#define FOX_METRICS_MIME_TYPE "text/plain; version=0.0.4"
 
 namespace fox {
-    Gateway* Gateway::s_instance = nullptr;
-
-    Gateway::Gateway(std::string address, kstd::u32 port, kstd::u32 backlog, std::string password) noexcept:
-            _address(std::move(address)),
-            _port(port),
-            _backlog(backlog),
-            _password(std::move(password)),
-            _is_running(true),
-            _is_online(false),
-            _state(),
-            _total_task_count(0),
-            _total_processed_count(0) {
-        s_instance = this;
+    Gateway::Gateway(GatewayConfig config) noexcept:
+            _address(std::move(config.address)),
+            _port(config.port),
+            _worker_count(config.worker_count),
+            _max_devices(config.max_devices),
+            _max_waiters(config.max_waiters),
+            _max_streams((config.worker_count != 0 ? config.worker_count : CPPHTTPLIB_THREAD_POOL_COUNT) / 2),
+            _ws_port(config.ws_port),
+            _password(config.password),
+            _is_running(false),
+            _ws_server(config.max_ws_connections, [this](WebSocket& socket) {
+                handle_websocket(socket);
+            }),
+            _device_config{config.backlog, config.queue, config.max_subscribers, config.event_buffer_size, std::chrono::seconds(config.token_lifetime), config.log_directory, &_task_log_syncer, config.spill_directory, &_residence_tracker},
+            _fetch_waiter_count(0),
+            _state_waiter_count(0),
+            _stream_count(0) {
+        // Single-device setups keep working without ever naming a device
+        static_cast<void>(get_or_create_device(std::string(default_device_id)));
+
+        if (!_device_config.log_directory.empty()) {
+            restore_logged_devices(_device_config.log_directory);
+        }
 
         register_commands();
-        _command_thread = std::thread(command_loop, this);
-        run_server();
+        register_endpoints();
     }
 
     Gateway::~Gateway() noexcept {
-        _is_running = false;
-        _command_thread.join();
+        stop();
+        wait();
+    }
+
+    auto Gateway::start() noexcept -> bool {
+        if (_port == 0) {
+            const auto port = _server.bind_to_any_port(_address);
+
+            if (port < 0) {
+                spdlog::error("Could not bind to any port on {}", _address);
+                return false;
+            }
+
+            _port = static_cast<kstd::u32>(port);
+        }
+        else if (!_server.bind_to_port(_address, static_cast<kstd::i32>(_port))) {
+            spdlog::error("Could not bind to {}:{}", _address, _port);
+            return false;
+        }
+
+        _is_running = true;
+
+        if (_ws_port != 0) {
+            _ws_thread = std::thread([this] {
+                _ws_server.listen(_address, _ws_port);
+            });
+        }
+
+        spdlog::info("Listening on {}:{}", _address, _port);
+
+        _server_thread = std::thread([this] {
+            _server.listen_after_bind();
+        });
+
+        // Otherwise a stop right after starting could slip in before the server runs, and it would never return
+        _server.wait_until_ready();
+        return true;
+    }
+
+    auto Gateway::stop() noexcept -> void {
+        if (!_is_running.exchange(false)) {
+            return;
+        }
+
+        _devices.for_each([](const DeviceMap::value_type& entry) {
+            entry.second->close();
+        });
+
+        _ws_server.stop();
+        _server.stop();
+    }
+
+    auto Gateway::wait() noexcept -> void {
+        if (_server_thread.joinable()) {
+            _server_thread.join();
+        }
+
+        if (_ws_thread.joinable()) {
+            _ws_thread.join();
+        }
+    }
+
+    auto Gateway::run_command(const std::string& command) noexcept -> bool {
+        const auto itr = _commands.find(command);
+
+        if (itr == _commands.end()) {
+            return false;
+        }
+
+        itr->second();
+        return true;
+    }
+
+    auto Gateway::find_device(const std::string& id) const noexcept -> std::shared_ptr<Device> {
+        std::shared_ptr<Device> device;
+
+        _devices.if_contains(id, [&device](const DeviceMap::value_type& entry) {
+            device = entry.second;
+        });
+
+        return device;
+    }
+
+    auto Gateway::get_or_create_device(const std::string& id) noexcept -> std::shared_ptr<Device> {
+        if (auto device = find_device(id)) {
+            return device;
+        }
+
+        if (_devices.size() >= _max_devices) {
+            return nullptr;
+        }
+
+        std::shared_ptr<Device> device;
+
+        // Someone else may have created it in the meantime, only the shard lock decides
+        _devices.lazy_emplace_l(id, [&device](const DeviceMap::value_type& entry) {
+            device = entry.second;
+        }, [&](const DeviceMap::constructor& constructor) {
+            device = std::make_shared<Device>(id, _device_config);
+            constructor(id, device);
+            spdlog::info("Registered device {}", id);
+        });
+
+        return device;
+    }
+
+    auto Gateway::restore_logged_devices(const std::filesystem::path& directory) noexcept -> void {
+        std::error_code error;
+
+        for (const auto& entry: std::filesystem::directory_iterator(directory, error)) {
+            const auto id = entry.path().filename().string();
+
+            if (!entry.is_directory(error) || !is_valid_device_id(id)) {
+                continue;
+            }
+
+            if (get_or_create_device(id) == nullptr) {
+                spdlog::warn("Could not restore device {}, too many devices", id);
+            }
+        }
+    }
+
+    auto Gateway::instrument(Endpoint endpoint, Handler handler) noexcept -> httplib::Server::Handler {
+        return [this, endpoint, handler](const httplib::Request& req, httplib::Response& res) {
+            const auto start = std::chrono::steady_clock::now();
+            (this->*handler)(req, res);
+            const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            _metrics.record_request(endpoint, res.status, latency, req.body.size(), res.body.size());
+        };
+    }
+
+    auto Gateway::fetch_tasks(Device& device, kstd::usize max_count) noexcept -> std::span<const dto::Task> {
+        const auto tasks = device.dequeue_buffered(max_count);
+        _metrics.record_fetch(tasks.size());
+        return tasks;
+    }
+
+    auto Gateway::try_wait_for_tasks(Device& device, std::chrono::milliseconds timeout) noexcept -> void {
+        if (device.get_task_count() > 0) {
+            return;
+        }
+
+        // Bound the number of parked fetches, so they can't occupy the entire worker pool
+        if (_fetch_waiter_count.fetch_add(1) >= _max_waiters) {
+            --_fetch_waiter_count;
+            return;
+        }
+
+        device.wait_for_tasks(timeout);
+        --_fetch_waiter_count;
+    }
+
+    auto Gateway::try_open_stream() noexcept -> bool {
+        if (_stream_count.fetch_add(1) >= _max_streams) {
+            --_stream_count;
+            return false;
+        }
+
+        return true;
+    }
+
+    auto Gateway::close_stream() noexcept -> void {
+        --_stream_count;
     }
 
-    auto Gateway::dequeue_and_compile() noexcept -> nlohmann::json {
-        _tasks_mutex.lock_shared();
-        const auto task_count = _tasks.size();
-        _tasks_mutex.unlock_shared();
+    auto Gateway::try_wait_for_state_change(Device& device, kstd::u64 version, std::chrono::milliseconds timeout) noexcept -> void {
+        if (device.get_versioned_state().version != version) {
+            return;
+        }
+
+        // Bounded separately from fetches, so dashboards can't starve the controller
+        if (_state_waiter_count.fetch_add(1) >= _max_waiters) {
+            --_state_waiter_count;
+            return;
+        }
+
+        device.wait_for_state_change(version, timeout);
+        --_state_waiter_count;
+    }
 
+    auto Gateway::compile_tasks(std::span<const dto::Task> tasks) noexcept -> nlohmann::json {
         auto array = nlohmann::json::array();
 
-        for (size_t i = 0; i < task_count; ++i) {
-            auto task = nlohmann::json::object();
-            dequeue_task()->serialize(task);
-            array.push_back(task);
+        for (auto task: tasks) {
+            auto task_obj = nlohmann::json::object();
+            task.serialize(task_obj);
+            array.push_back(task_obj);
         }
 
         return array;
     }
 
+    auto Gateway::write_tasks(JsonWriter& writer, std::span<const dto::Task> tasks) noexcept -> void {
+        writer.begin_array();
+
+        for (const auto& task: tasks) {
+            writer.write_object(task);
+        }
+
+        writer.end_array();
+    }
+
     auto Gateway::register_commands() noexcept -> void {
         _commands["help"] = [this] {
             for (const auto& pair: _commands) {
@@ -63,55 +257,95 @@ namespace fox {
 
         _commands["exit"] = [this] {
             spdlog::info("Shutting down gracefully");
-            _is_running = false;
-            _server.stop();
+            stop();
         };
 
         _commands["clear"] = [this] {
-            spdlog::info("Clearing task queue");
-            _tasks_mutex.lock();
-            _tasks.clear();
-            _tasks_mutex.unlock();
+            spdlog::info("Clearing task queues");
+
+            _devices.for_each([](const DeviceMap::value_type& entry) {
+                entry.second->clear_tasks();
+            });
         };
 
         _commands["info"] = [this] {
-            _tasks_mutex.lock_shared();
-            spdlog::info("{} tasks queued in total", _tasks.size());
-            _tasks_mutex.unlock_shared();
+            kstd::usize task_count = 0;
+            kstd::usize spilled_count = 0;
+            kstd::usize total_task_count = 0;
+            kstd::usize total_processed_count = 0;
+
+            _devices.for_each([&](const DeviceMap::value_type& entry) {
+                task_count += entry.second->get_task_count();
+                spilled_count += entry.second->get_tasks().get_spilled_count();
+                total_task_count += entry.second->get_total_task_count();
+                total_processed_count += entry.second->get_total_processed_count();
+            });
+
+            spdlog::info("{} devices registered", _devices.size());
+            spdlog::info("{} tasks queued in total", task_count);
+            spdlog::info("{} of them spilled to disk", spilled_count);
+
+            spdlog::info("{} tasks in total", total_task_count);
+            spdlog::info("{} tasks processed", total_processed_count);
+        };
+
+        _commands["slowest"] = [this] {
+            const auto slow_tasks = _residence_tracker.get_slow_tasks();
+
+            if (slow_tasks.empty()) {
+                spdlog::info("No tasks handed out recently");
+                return;
+            }
+
+            for (const auto& slow_task: slow_tasks) {
+                auto task = nlohmann::json::object();
+                slow_task.task.serialize(task);
+                spdlog::info("{}: queued for {:.3f}ms, handed out at {}: {}", slow_task.device, static_cast<double>(slow_task.residence_time) / 1000.0, slow_task.timestamp, task.dump());
+            }
+        };
 
-            spdlog::info("{} tasks in total", _total_task_count);
-            spdlog::info("{} tasks processed", _total_processed_count);
+        _commands["devices"] = [this] {
+            _devices.for_each([](const DeviceMap::value_type& entry) {
+                const auto& device = *entry.second;
+                spdlog::info("{}: {}, {} tasks queued", device.get_id(), device.is_online() ? "online" : "offline", device.get_task_count());
+            });
         };
     }
 
-    auto Gateway::run_server() noexcept -> void {
-        spdlog::info("Starting HTTP server");
+    auto Gateway::register_endpoints() noexcept -> void {
+        if (_worker_count != 0) {
+            // Every gateway gets a pool of its own, so shards in one process don't steal each other's workers
+            _server.new_task_queue = [worker_count = _worker_count] {
+                return new httplib::ThreadPool(worker_count);
+            };
+        }
 
         _server.set_error_handler(handle_error);
 
         // Web endpoints
-        _server.Get("/status", handle_status);
+        _server.Get("/status", instrument(Endpoint::STATUS, &Gateway::handle_status));
+        _server.Get("/metrics", instrument(Endpoint::METRICS, &Gateway::handle_metrics));
+        _server.Get("/events", instrument(Endpoint::EVENTS, &Gateway::handle_events));
 
         // Client endpoints
-        _server.Post("/getstate", handle_getstate);
-        _server.Post("/authenticate", handle_authenticate);
-        _server.Post("/enqueue", handle_enqueue);
+        _server.Post("/getstate", instrument(Endpoint::GETSTATE, &Gateway::handle_getstate));
+        _server.Post("/authenticate", instrument(Endpoint::AUTHENTICATE, &Gateway::handle_authenticate));
+        _server.Post("/enqueue", instrument(Endpoint::ENQUEUE, &Gateway::handle_enqueue));
 
         // Server endpoints
-        _server.Post("/fetch", handle_fetch);
-        _server.Post("/setstate", handle_setstate);
-        _server.Post("/setonline", handle_setonline);
-        _server.Post("/newsession", handle_newsession);
+        _server.Post("/fetch", instrument(Endpoint::FETCH, &Gateway::handle_fetch));
+        _server.Post("/setstate", instrument(Endpoint::SETSTATE, &Gateway::handle_setstate));
+        _server.Post("/setonline", instrument(Endpoint::SETONLINE, &Gateway::handle_setonline));
+        _server.Post("/sync", instrument(Endpoint::SYNC, &Gateway::handle_sync));
+        _server.Post("/newsession", instrument(Endpoint::NEWSESSION, &Gateway::handle_newsession));
 
         _server.set_default_headers({ // @formatter:off
             std::make_pair("Access-Control-Allow-Origin", "*"),
             std::make_pair("Access-Control-Allow-Methods", "*"),
             std::make_pair("Access-Control-Allow-Headers", "*"),
+            std::make_pair("Access-Control-Expose-Headers", "ETag"),
             std::make_pair("Cache-Control", "private,max-age=0") // https://developers.cloudflare.com/cache/about/cache-control/
         }); // @formatter:on
-
-        spdlog::info("Listening on {}:{}", _address, _port);
-        _server.listen(_address, static_cast<kstd::i32>(_port)); // This will block
     }
 
     auto Gateway::generate_password(kstd::usize length) noexcept -> std::string {
@@ -132,79 +366,170 @@ namespace fox {
     }
 
     auto Gateway::send_error(httplib::Response& res, kstd::i32 status, const std::string_view& message) noexcept -> void {
-        auto res_body = nlohmann::json::object();
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
 
-        res_body["status"] = false;
-        res_body["error"] = message;
-        res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.write_field("status", false);
+        writer.write_field("error", message);
+        writer.write_field("timestamp", static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+        writer.end_object();
 
         res.status = status;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
+        res.set_content(buffer.data(), buffer.size(), FOX_JSON_MIME_TYPE);
     }
 
-    auto Gateway::validate_server_password(const nlohmann::json& json) -> bool {
-        if (!json.contains("password")) {
-            return false;
+    auto Gateway::get_request_format(const httplib::Request& req) noexcept -> codec::WireFormat {
+        return codec::parse_format(req.get_header_value("Content-Type")).value_or(codec::WireFormat::JSON);
+    }
+
+    auto Gateway::get_response_format(const httplib::Request& req) noexcept -> codec::WireFormat {
+        // An explicit Accept wins, otherwise we answer in whatever the client sent us
+        if (const auto format = codec::parse_format(req.get_header_value("Accept"))) {
+            return *format;
         }
 
-        auto& self = *s_instance;
-        const auto& password = static_cast<std::string>(json["password"]);
+        return get_request_format(req);
+    }
+
+    auto Gateway::parse_body(const httplib::Request& req) -> nlohmann::json {
+        return codec::decode(get_request_format(req), req.body);
+    }
 
-        self._password_mutex.lock_shared();
+    auto Gateway::send_body(const httplib::Request& req, httplib::Response& res, const nlohmann::json& body) -> void {
+        auto format = get_response_format(req);
 
-        if (password.empty() || password != self._password) {
-            self._password_mutex.unlock_shared();
-            return false;
+        if (format == codec::WireFormat::PACKED) {
+            format = codec::WireFormat::JSON; // Only a few endpoints have a packed representation
         }
 
-        self._password_mutex.unlock_shared();
-        return true;
+        res.status = 200;
+        res.set_content(codec::encode(format, body), codec::get_mime_type(format));
     }
 
-    auto Gateway::validate_client_password(const nlohmann::json& json) -> bool {
-        if (!json.contains("password")) {
-            return false;
+    auto Gateway::check_server_password(std::string_view password) const noexcept -> bool {
+        return _password.matches(password);
+    }
+
+    auto Gateway::get_bearer_credential(const httplib::Request& req) noexcept -> std::optional<std::string_view> {
+        constexpr std::string_view scheme = "Bearer ";
+        const auto header = req.headers.find("Authorization");
+
+        if (header == req.headers.end()) {
+            return std::nullopt;
+        }
+
+        const std::string_view value = header->second;
+
+        if (!value.starts_with(scheme)) {
+            return std::string_view();
+        }
+
+        return value.substr(scheme.size());
+    }
+
+    auto Gateway::check_bearer_token(const httplib::Request& req, const Device& device) noexcept -> TokenStatus {
+        const auto credential = get_bearer_credential(req);
+
+        if (!credential) {
+            return TokenStatus::MISSING;
         }
 
-        auto& self = *s_instance;
-        const auto& password = static_cast<std::string>(json["password"]);
+        if (!device.check_session_token(*credential)) {
+            return TokenStatus::INVALID;
+        }
+
+        return TokenStatus::VALID;
+    }
 
-        self._session_password_mutex.lock_shared();
-        const auto& session_password = self._session_password;
+    auto Gateway::get_string_property(const nlohmann::json& json, const char* name) noexcept -> std::string_view {
+        const auto property = json.find(name);
 
-        if (password.empty() || session_password.empty() || password != session_password) {
-            self._session_password_mutex.unlock_shared();
+        if (property == json.end() || !property->is_string()) {
+            return {};
+        }
+
+        return property->get_ref<const std::string&>();
+    }
+
+    auto Gateway::validate_server_password(const nlohmann::json& json) const noexcept -> bool {
+        return check_server_password(get_string_property(json, "password"));
+    }
+
+    auto Gateway::validate_client_password(const Device& device, const nlohmann::json& json) noexcept -> bool {
+        return device.check_session_password(get_string_property(json, "password"));
+    }
+
+    auto Gateway::is_valid_device_id(std::string_view id) noexcept -> bool {
+        if (id.empty() || id.size() > max_device_id_length) {
             return false;
         }
 
-        self._session_password_mutex.unlock_shared();
-        return true;
+        return std::all_of(id.begin(), id.end(), [](char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+        });
     }
 
-    auto Gateway::command_loop(Gateway* self) noexcept -> void {
-        using namespace std::chrono_literals;
+    auto Gateway::make_etag(kstd::u64 version) noexcept -> std::string {
+        return fmt::format("\"{}\"", version);
+    }
 
-        spdlog::info("Starting command thread");
-        std::string command;
+    auto Gateway::parse_etag(std::string_view header) noexcept -> std::optional<kstd::u64> {
+        auto tag = header.substr(0, header.find(','));
 
-        while (self->_is_running) {
-            std::getline(std::cin, command);
+        while (!tag.empty() && tag.front() == ' ') {
+            tag.remove_prefix(1);
+        }
 
-            if (command.empty()) {
-                continue;
-            }
+        if (tag.starts_with("W/")) {
+            tag.remove_prefix(2);
+        }
+
+        if (tag.size() < 3 || tag.front() != '"' || tag.back() != '"') {
+            return std::nullopt;
+        }
 
-            const auto itr = self->_commands.find(command);
+        tag = tag.substr(1, tag.size() - 2);
+        kstd::u64 version = 0;
+        const auto [end, error] = std::from_chars(tag.data(), tag.data() + tag.size(), version);
 
-            if (itr == self->_commands.end()) {
-                spdlog::info("Unrecognized command, try help");
-                continue;
+        if (error != std::errc() || end != tag.data() + tag.size()) {
+            return std::nullopt;
+        }
+
+        return version;
+    }
+
+    auto Gateway::resolve_device(const httplib::Request& req, httplib::Response& res, bool create) noexcept -> std::shared_ptr<Device> {
+        auto id = req.get_param_value("device");
+
+        if (id.empty()) {
+            id = default_device_id;
+        }
+
+        if (!is_valid_device_id(id)) {
+            send_error(res, 500, "Invalid device id");
+            return nullptr;
+        }
+
+        if (!create) {
+            auto device = find_device(id);
+
+            if (device == nullptr) {
+                send_error(res, 404, "Unknown device");
             }
 
-            itr->second();
+            return device;
+        }
+
+        auto device = get_or_create_device(id);
+
+        if (device == nullptr) {
+            send_error(res, 503, "Too many devices");
         }
 
-        spdlog::info("Stopping command thread");
+        return device;
     }
 
     auto Gateway::handle_error(const httplib::Request& req, httplib::Response& res) -> void {
@@ -230,14 +555,41 @@ namespace fox {
 
     auto Gateway::handle_status(const httplib::Request& req, httplib::Response& res) -> void {
         spdlog::debug("Received status request");
-        auto& self = *s_instance;
-
-        self._tasks_mutex.lock_shared();
-        const auto task_count = self._tasks.size();
-        self._tasks_mutex.unlock_shared();
 
-        const auto total_task_count = static_cast<size_t>(self._total_task_count);
-        const auto total_processed_count = static_cast<size_t>(self._total_processed_count);
+        kstd::usize task_count = 0;
+        kstd::usize total_task_count = 0;
+        kstd::usize total_processed_count = 0;
+
+        _devices.for_each([&](const DeviceMap::value_type& entry) {
+            task_count += entry.second->get_task_count();
+            total_task_count += entry.second->get_total_task_count();
+            total_processed_count += entry.second->get_total_processed_count();
+        });
+
+        const auto& residence_times = _residence_tracker.get_residence_times();
+        const auto residence_median = residence_times.get_quantile(0.5);
+        const auto residence_p90 = residence_times.get_quantile(0.9);
+        const auto residence_p99 = residence_times.get_quantile(0.99);
+        const auto residence_p999 = residence_times.get_quantile(0.999);
+
+        // Scripts ask for a data format, browsers don't
+        if (codec::parse_format(req.get_header_value("Accept"))) {
+            auto res_body = nlohmann::json::object();
+            res_body["devices"] = _devices.size();
+            res_body["queued"] = task_count;
+            res_body["total"] = total_task_count;
+            res_body["processed"] = total_processed_count;
+            res_body["residence_us"] = {
+                {"count", residence_times.get_count()},
+                {"p50", residence_median},
+                {"p90", residence_p90},
+                {"p99", residence_p99},
+                {"p999", residence_p999}
+            };
+
+            send_body(req, res, res_body);
+            return;
+        }
 
         res.status = 200;
 
@@ -250,13 +602,173 @@ namespace fox {
                 <body>
                     <h1>🦊 Status</h1>
                     <hr>
+                    <h2>Devices</h2>
+                    <h3>Registered Devices: {}</h3>
                     <h2>Task Queue</h2>
                     <h3>Queued Tasks: {}</h3>
                     <h3>Total Tasks: {}</h3>
                     <h3>Total Processed: {}</h3>
+                    <h2>Time Queued</h2>
+                    <h3>Median: {:.3f}ms</h3>
+                    <h3>90th Percentile: {:.3f}ms</h3>
+                    <h3>99th Percentile: {:.3f}ms</h3>
+                    <h3>99.9th Percentile: {:.3f}ms</h3>
                 </body>
             </html>
-        )*", task_count, total_task_count, total_processed_count), FOX_HTML_MIME_TYPE);
+        )*", _devices.size(), task_count, total_task_count, total_processed_count,
+            static_cast<double>(residence_median) / 1000.0, static_cast<double>(residence_p90) / 1000.0,
+            static_cast<double>(residence_p99) / 1000.0, static_cast<double>(residence_p999) / 1000.0), FOX_HTML_MIME_TYPE);
+    }
+
+    auto Gateway::handle_metrics(const httplib::Request& req, httplib::Response& res) -> void {
+        spdlog::debug("Received metrics request");
+
+        thread_local fmt::memory_buffer buffer;
+        buffer.clear();
+        _metrics.write(buffer);
+
+        auto out = std::back_inserter(buffer);
+        fmt::format_to(out, "# HELP fox_task_residence_seconds Time tasks spent queued before being handed out\n# TYPE fox_task_residence_seconds histogram\n");
+        _residence_tracker.get_residence_times().write(buffer, "fox_task_residence_seconds", "", 1e6);
+        fmt::format_to(out, "# HELP fox_devices Registered devices\n# TYPE fox_devices gauge\nfox_devices {}\n", _devices.size());
+        fmt::format_to(out, "# HELP fox_fetch_waiters Fetch requests waiting for tasks\n# TYPE fox_fetch_waiters gauge\nfox_fetch_waiters {}\n", _fetch_waiter_count.load());
+        fmt::format_to(out, "# HELP fox_state_waiters State requests waiting for a change\n# TYPE fox_state_waiters gauge\nfox_state_waiters {}\n", _state_waiter_count.load());
+        fmt::format_to(out, "# HELP fox_event_streams Open event streams of all devices\n# TYPE fox_event_streams gauge\nfox_event_streams {}\n", _stream_count.load());
+        fmt::format_to(out, "# HELP fox_queue_depth Tasks queued per device, spilled ones included\n# TYPE fox_queue_depth gauge\n");
+
+        _devices.for_each([&](const DeviceMap::value_type& entry) {
+            fmt::format_to(out, "fox_queue_depth{{device=\"{}\"}} {}\n", entry.first, entry.second->get_task_count());
+        });
+
+        fmt::format_to(out, "# HELP fox_queue_spilled Tasks spilled to disk per device\n# TYPE fox_queue_spilled gauge\n");
+
+        _devices.for_each([&](const DeviceMap::value_type& entry) {
+            fmt::format_to(out, "fox_queue_spilled{{device=\"{}\"}} {}\n", entry.first, entry.second->get_tasks().get_spilled_count());
+        });
+
+        res.status = 200;
+        res.set_content(buffer.data(), buffer.size(), FOX_METRICS_MIME_TYPE);
+    }
+
+    auto Gateway::handle_events(const httplib::Request& req, httplib::Response& res) -> void {
+        spdlog::debug("Received events request");
+
+        const auto token = req.get_param_value("token"); // EventSource can't send custom headers
+        const auto credential = get_bearer_credential(req);
+
+        // Passwords are only taken from the header, query strings end up in proxy and access logs
+        if (credential && check_server_password(*credential)) {
+            const auto device = resolve_device(req, res, true);
+
+            if (device == nullptr) {
+                return;
+            }
+
+            if (!try_open_stream()) {
+                send_error(res, 503, "Too many event streams");
+                return;
+            }
+
+            // The controller receives its tasks as they are enqueued, like a /fetch that never ends
+            if (!device->try_open_task_stream()) {
+                close_stream();
+                send_error(res, 503, "Too many event subscribers");
+                return;
+            }
+
+            res.status = 200;
+            res.set_chunked_content_provider(FOX_EVENT_STREAM_MIME_TYPE, [this, device](kstd::usize, httplib::DataSink& sink) {
+                if (!_is_running || !device->is_open()) {
+                    return false;
+                }
+
+                device->wait_for_tasks(event_keepalive_interval);
+
+                if (!sink.is_writable()) {
+                    return false; // Don't take tasks out of the queue for a dead connection
+                }
+
+                // Delivery is at most once: the tasks leave the queue before they are written, and pushing them
+                // back behind newer ones could make a stale conflated value win, so a broken write loses them
+                const auto tasks = fetch_tasks(*device, device->get_backlog());
+
+                if (tasks.empty()) {
+                    constexpr std::string_view keepalive = ": keepalive\n\n";
+                    return sink.write(keepalive.data(), keepalive.size());
+                }
+
+                thread_local fmt::memory_buffer buffer;
+                buffer.clear();
+
+                constexpr std::string_view prefix = "event: tasks\ndata: ";
+                constexpr std::string_view suffix = "\n\n";
+                buffer.append(prefix.data(), prefix.data() + prefix.size());
+                JsonWriter writer(buffer);
+                write_tasks(writer, tasks);
+                buffer.append(suffix.data(), suffix.data() + suffix.size());
+
+                if (!sink.write(buffer.data(), buffer.size())) {
+                    spdlog::warn("Lost {} tasks of device {} to a broken event stream", tasks.size(), device->get_id());
+                    _metrics.record_lost(tasks.size());
+                    return false;
+                }
+
+                return true;
+            }, [this, device](bool) {
+                device->close_task_stream();
+                close_stream();
+            });
+
+            return;
+        }
+
+        const auto device = resolve_device(req, res, false);
+
+        if (device == nullptr) {
+            return;
+        }
+
+        // Clients only get short-lived session tokens into the URL, never the session password
+        if (check_bearer_token(req, *device) != TokenStatus::VALID && !device->check_session_token(token)) {
+            send_error(res, 401, "Invalid token");
+            return;
+        }
+
+        if (!try_open_stream()) {
+            send_error(res, 503, "Too many event streams");
+            return;
+        }
+
+        auto stream = device->get_state_events().subscribe();
+
+        if (stream == nullptr) {
+            close_stream();
+            send_error(res, 503, "Too many event subscribers");
+            return;
+        }
+
+        // Make sure every client starts out with the current state
+        stream->push(device->serialize_state());
+
+        res.status = 200;
+        res.set_chunked_content_provider(FOX_EVENT_STREAM_MIME_TYPE, [stream](kstd::usize, httplib::DataSink& sink) {
+            const auto event = stream->wait_pop(event_keepalive_interval);
+
+            if (!event) {
+                return false; // Closed by the gateway or dropped for being too slow
+            }
+
+            if (event->empty()) {
+                constexpr std::string_view keepalive = ": keepalive\n\n";
+                return sink.write(keepalive.data(), keepalive.size());
+            }
+
+            const auto message = fmt::format("event: state\ndata: {}\n\n", *event);
+            return sink.write(message.data(), message.size());
+        }, [this, device, stream](bool) {
+            device->get_state_events().unsubscribe(stream);
+            close_stream();
+        });
     }
 
     // Client endpoints
@@ -264,96 +776,264 @@ namespace fox {
     auto Gateway::handle_authenticate(const httplib::Request& req, httplib::Response& res) -> void {
         spdlog::debug("Received authenticate request");
 
-        auto req_body = nlohmann::json::parse(req.body);
+        const auto device = resolve_device(req, res, false);
+
+        if (device == nullptr) {
+            return;
+        }
+
+        auto result = false;
+
+        switch (check_bearer_token(req, *device)) {
+            case TokenStatus::VALID: // Trade a valid token for a fresh one
+                result = true;
+                break;
+            case TokenStatus::INVALID:
+                break;
+            case TokenStatus::MISSING:
+                result = validate_client_password(*device, parse_body(req));
+                break;
+        }
 
         auto res_body = nlohmann::json::object();
-        const auto result = validate_client_password(req_body);
         res_body["status"] = result;
+
+        if (result) {
+            res_body["token"] = device->issue_session_token();
+            res_body["expires_in"] = static_cast<kstd::u64>(device->get_token_lifetime().count());
+        }
+
         res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
-        res.status = 200;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
+        send_body(req, res, res_body);
     }
 
     auto Gateway::handle_getstate(const httplib::Request& req, httplib::Response& res) -> void {
         spdlog::debug("Received getstate request");
 
-        auto& self = *s_instance;
-        const auto req_body = nlohmann::json::parse(req.body);
+        const auto device = resolve_device(req, res, false);
 
-        if (!req_body.is_object()) {
-            send_error(res, 500, "Invalid request body type");
+        if (device == nullptr) {
             return;
         }
 
-        if (!validate_client_password(req_body)) {
-            send_error(res, 401, "Invalid password");
+        const auto token_status = check_bearer_token(req, *device);
+
+        if (token_status == TokenStatus::INVALID) {
+            send_error(res, 401, "Invalid token");
             return;
         }
 
-        auto res_body = nlohmann::json::object();
-        self._state_mutex.lock_shared();
-        self._state.serialize(res_body);
-        self._state_mutex.unlock_shared();
+        nlohmann::json req_body;
 
-        res_body["is_online"] = static_cast<bool>(self._is_online);
-        res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        if (token_status == TokenStatus::MISSING) { // Tokens make the body optional
+            req_body = parse_body(req);
 
-        res.status = 200;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
-    }
+            if (!req_body.is_object()) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
 
-    auto Gateway::handle_enqueue(const httplib::Request& req, httplib::Response& res) -> void {
-        spdlog::debug("Received endpoint request");
+            if (!validate_client_password(*device, req_body)) {
+                send_error(res, 401, "Invalid password");
+                return;
+            }
+        }
+        else if (!req.body.empty()) {
+            req_body = parse_body(req);
+        }
 
-        auto& self = *s_instance;
-        const auto req_body = nlohmann::json::parse(req.body);
+        // Either an entity tag from a previous response or the version field of its body
+        auto known_version = parse_etag(req.get_header_value("If-None-Match"));
 
-        if (!req_body.is_object()) {
-            send_error(res, 500, "Invalid request body type");
+        if (!known_version && req_body.is_object() && req_body.contains("since_version")) {
+            const auto& version_obj = req_body["since_version"];
+
+            if (!version_obj.is_number_unsigned()) {
+                send_error(res, 500, "Invalid property type");
+                return;
+            }
+
+            known_version = static_cast<kstd::u64>(version_obj);
+        }
+
+        // Readers holding a version may ask for just the fields that changed since
+        auto is_delta = false;
+
+        if (req_body.is_object() && req_body.contains("delta")) {
+            const auto& delta_obj = req_body["delta"];
+
+            if (!delta_obj.is_boolean()) {
+                send_error(res, 500, "Invalid property type");
+                return;
+            }
+
+            is_delta = static_cast<bool>(delta_obj);
+        }
+
+        if (known_version) {
+            if (req_body.is_object() && req_body.contains("wait_ms")) {
+                const auto& wait_obj = req_body["wait_ms"];
+
+                if (!wait_obj.is_number_unsigned()) {
+                    send_error(res, 500, "Invalid property type");
+                    return;
+                }
+
+                const auto timeout = std::min(std::chrono::milliseconds(static_cast<kstd::u64>(wait_obj)), max_fetch_wait);
+
+                if (timeout.count() > 0) {
+                    try_wait_for_state_change(*device, *known_version, timeout);
+                }
+            }
+
+            const auto state = device->get_versioned_state();
+
+            // Nothing changed, so there is nothing to serialize either
+            if (state.version == *known_version) {
+                res.status = 304;
+                res.set_header("ETag", make_etag(*known_version));
+                return;
+            }
+
+            // Versions of another run fall through to the full state, packed responses have a fixed layout
+            if (is_delta && device->is_delta_base(state, *known_version) && get_response_format(req) != codec::WireFormat::PACKED) {
+                res.set_header("ETag", make_etag(state.version));
+
+                if (get_response_format(req) == codec::WireFormat::JSON) {
+                    res.status = 200;
+                    res.set_content(device->serialize_delta(state, *known_version), FOX_JSON_MIME_TYPE);
+                    return;
+                }
+
+                send_body(req, res, device->compile_delta(state, *known_version));
+                return;
+            }
+        }
+
+        if (get_response_format(req) == codec::WireFormat::PACKED) {
+            // [state][is_online: u8][timestamp: u64]
+            std::string res_body;
+            res_body.reserve(dto::DeviceState::packed_size + 9);
+            const auto state = device->get_versioned_state();
+            state.state.pack(res_body);
+            res_body.push_back(static_cast<char>(state.is_online ? 1 : 0));
+            dto::pack_u64(res_body, static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+
+            res.status = 200;
+            res.set_header("ETag", make_etag(state.version));
+            res.set_content(res_body, FOX_PACKED_MIME_TYPE);
             return;
         }
 
-        if (!validate_client_password(req_body)) {
-            send_error(res, 401, "Invalid password");
+        if (get_response_format(req) == codec::WireFormat::JSON) {
+            // Serialized once per state change, all that's left per poll is copying it
+            const auto body = device->get_state_body();
+
+            res.status = 200;
+            res.set_header("ETag", make_etag(body->version));
+            res.set_content(body->serialize(), FOX_JSON_MIME_TYPE);
             return;
         }
 
-        if (!req_body.contains("tasks")) {
-            send_error(res, 500, "Missing tasks list");
+        const auto state = device->compile_state();
+        res.set_header("ETag", make_etag(static_cast<kstd::u64>(state["version"])));
+        send_body(req, res, state);
+    }
+
+    auto Gateway::handle_enqueue(const httplib::Request& req, httplib::Response& res) -> void {
+        spdlog::debug("Received endpoint request");
+
+        const auto device = resolve_device(req, res, false);
+
+        if (device == nullptr) {
             return;
         }
 
-        const auto& tasks = req_body["tasks"];
+        const auto token_status = check_bearer_token(req, *device);
+        kstd::usize task_count = 0;
+        kstd::usize queued_count = 0;
 
-        if (!tasks.is_array()) {
-            send_error(res, 500, "Invalid tasks list type");
+        if (token_status == TokenStatus::INVALID) {
+            send_error(res, 401, "Invalid token");
             return;
         }
 
-        size_t queued_count = 0;
+        if (get_request_format(req) == codec::WireFormat::PACKED) {
+            const auto packed = codec::split_packed(req.body);
 
-        for (const auto& task: tasks) {
-            if (!task.is_object() || !task.contains("type")) {
-                continue;
+            if (!packed || packed->payload.size() % dto::Task::packed_size != 0) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            if (token_status != TokenStatus::VALID && !device->check_session_password(packed->password)) {
+                send_error(res, 401, "Invalid password");
+                return;
+            }
+
+            task_count = packed->payload.size() / dto::Task::packed_size;
+
+            for (kstd::usize i = 0; i < task_count; ++i) {
+                dto::Task task{};
+
+                if (task.unpack(packed->payload.data() + i * dto::Task::packed_size) && device->enqueue_task(task)) {
+                    ++queued_count;
+                }
+            }
+        }
+        else {
+            // Decodes tasks without building a DOM, reused so its buffers stay warm
+            thread_local EnqueueParser parser;
+
+            if (!parser.parse(req.body, codec::get_input_format(get_request_format(req)))) {
+                send_error(res, 500, "Malformed request body");
+                return;
+            }
+
+            if (!parser.is_object()) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            if (token_status != TokenStatus::VALID && (!parser.has_password() || !device->check_session_password(parser.get_password()))) {
+                send_error(res, 401, "Invalid password");
+                return;
+            }
+
+            if (!parser.has_tasks()) {
+                send_error(res, 500, "Missing tasks list");
+                return;
+            }
+
+            if (!parser.is_tasks_array()) {
+                send_error(res, 500, "Invalid tasks list type");
+                return;
             }
 
-            dto::Task task_dto{};
-            task_dto.deserialize(task);
+            task_count = parser.get_task_count();
 
-            if (self.enqueue_task(task_dto)) {
-                spdlog::debug("Enqueued task");
-                ++queued_count;
+            for (const auto& task: parser.get_tasks()) {
+                if (device->enqueue_task(task)) {
+                    ++queued_count;
+                }
             }
         }
 
+        _metrics.record_enqueue(queued_count, task_count - queued_count);
+
+        // Only acknowledge what would survive a restart
+        if (queued_count > 0 && !device->sync_tasks()) {
+            send_error(res, 500, "Could not persist tasks");
+            return;
+        }
+
         auto res_body = nlohmann::json::object();
-        res_body["status"] = queued_count == tasks.size();
+        res_body["status"] = queued_count == task_count;
         res_body["queued"] = queued_count;
         res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
-        res.status = 200;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
+        send_body(req, res, res_body);
     }
 
     // Server endpoints
@@ -362,8 +1042,7 @@ namespace fox {
         using namespace nlohmann::literals;
         spdlog::debug("Received fetch request");
 
-        auto& self = *s_instance;
-        auto req_body = nlohmann::json::parse(req.body);
+        auto req_body = parse_body(req);
 
         if (!req_body.is_object()) {
             send_error(res, 500, "Invalid request body type");
@@ -375,16 +1054,229 @@ namespace fox {
             return;
         }
 
+        const auto device = resolve_device(req, res, true);
+
+        if (device == nullptr) {
+            return;
+        }
+
+        kstd::usize max_count = device->get_backlog();
+        auto timeout = std::chrono::milliseconds(0);
+
+        if (!parse_fetch_limits(req_body, res, max_count, timeout)) {
+            return;
+        }
+
+        if (timeout.count() > 0) {
+            try_wait_for_tasks(*device, timeout);
+        }
+
+        send_tasks(req, res, *device, max_count);
+    }
+
+    auto Gateway::handle_sync(const httplib::Request& req, httplib::Response& res) -> void {
+        spdlog::debug("Received sync request");
+
+        dto::DeviceState state{};
+        dto::FieldMask mask = 0;
+        std::optional<bool> is_online;
+        auto req_body = nlohmann::json::object();
+        const auto is_packed = get_request_format(req) == codec::WireFormat::PACKED;
+        kstd::u16 packed_max = 0;
+        kstd::u32 packed_wait_ms = 0;
+
+        if (is_packed) {
+            // [is_online: u8, 2 leaves it alone][max: u16, 0 for the whole backlog][wait_ms: u32][state, full, partial or left out]
+            constexpr kstd::usize header_size = 7;
+            const auto packed = codec::split_packed(req.body);
+
+            if (!packed || packed->payload.size() < header_size || static_cast<kstd::u8>(packed->payload[0]) > 2) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            packed_max = dto::unpack_u16(packed->payload.data() + 1);
+            packed_wait_ms = dto::unpack_u32(packed->payload.data() + 3);
+            const auto state_data = packed->payload.substr(header_size);
+
+            if (dto::DeviceState::is_packed_partial(state_data)) {
+                const auto partial_mask = state.unpack_partial(state_data);
+
+                if (!partial_mask) {
+                    send_error(res, 500, "Invalid request body type");
+                    return;
+                }
+
+                mask = *partial_mask;
+            }
+            else if (state_data.size() == dto::DeviceState::packed_size) {
+                state.unpack(state_data.data());
+                mask = dto::all_fields<dto::DeviceState>;
+            }
+            else if (!state_data.empty()) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            if (!check_server_password(packed->password)) {
+                send_error(res, 401, "Invalid password");
+                return;
+            }
+
+            if (packed->payload[0] != 2) {
+                is_online = packed->payload[0] != 0;
+            }
+        }
+        else {
+            req_body = parse_body(req);
+
+            if (!req_body.is_object()) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            if (!validate_server_password(req_body)) {
+                send_error(res, 401, "Invalid password");
+                return;
+            }
+
+            if (req_body.contains("state")) {
+                const auto& state_obj = req_body["state"];
+
+                if (!state_obj.is_object()) {
+                    send_error(res, 500, "Invalid state object type");
+                    return;
+                }
+
+                mask = state.deserialize_partial(state_obj);
+            }
+
+            if (req_body.contains("is_online")) {
+                const auto& online_obj = req_body["is_online"];
+
+                if (!online_obj.is_boolean()) {
+                    send_error(res, 500, "Invalid property type");
+                    return;
+                }
+
+                is_online = static_cast<bool>(online_obj);
+            }
+        }
+
+        const auto device = resolve_device(req, res, true);
+
+        if (device == nullptr) {
+            return;
+        }
+
+        kstd::usize max_count = device->get_backlog();
+        auto timeout = std::chrono::milliseconds(0);
+
+        if (is_packed) {
+            apply_fetch_limits(packed_max, packed_wait_ms, max_count, timeout);
+        }
+        else if (!parse_fetch_limits(req_body, res, max_count, timeout)) {
+            return;
+        }
+
+        if (mask != 0 || is_online) {
+            if (is_online && !*is_online) { // Reset active session on disconnect, like /setonline
+                device->end_session();
+            }
+
+            static_cast<void>(device->apply_report(state, mask, is_online));
+        }
+
+        if (timeout.count() > 0) {
+            try_wait_for_tasks(*device, timeout);
+        }
+
+        send_tasks(req, res, *device, max_count);
+    }
+
+    auto Gateway::parse_fetch_limits(const nlohmann::json& req_body, httplib::Response& res, kstd::usize& max_count, std::chrono::milliseconds& timeout) -> bool {
+        kstd::u64 max = 0;
+        kstd::u64 wait_ms = 0;
+
+        if (req_body.contains("max")) {
+            const auto& max_obj = req_body["max"];
+
+            if (!max_obj.is_number_unsigned() || max_obj == 0) {
+                send_error(res, 500, "Invalid property type");
+                return false;
+            }
+
+            max = static_cast<kstd::u64>(max_obj);
+        }
+
+        if (req_body.contains("wait_ms")) {
+            const auto& wait_obj = req_body["wait_ms"];
+
+            if (!wait_obj.is_number_unsigned()) {
+                send_error(res, 500, "Invalid property type");
+                return false;
+            }
+
+            wait_ms = static_cast<kstd::u64>(wait_obj);
+        }
+
+        apply_fetch_limits(max, wait_ms, max_count, timeout);
+        return true;
+    }
+
+    auto Gateway::apply_fetch_limits(kstd::u64 max, kstd::u64 wait_ms, kstd::usize& max_count, std::chrono::milliseconds& timeout) noexcept -> void {
+        if (max != 0) {
+            max_count = static_cast<kstd::usize>(std::min<kstd::u64>(max_count, max));
+        }
+
+        // Clamped before the conversion, huge values would overflow the signed duration
+        timeout = std::chrono::milliseconds(std::min<kstd::u64>(wait_ms, max_fetch_wait.count()));
+    }
+
+    auto Gateway::send_tasks(const httplib::Request& req, httplib::Response& res, Device& device, kstd::usize max_count) -> void {
+        if (get_response_format(req) == codec::WireFormat::PACKED) {
+            // [timestamp: u64][task_count: u32][tasks]
+            const auto tasks = fetch_tasks(device, max_count);
+            std::string res_body;
+            res_body.reserve(12 + tasks.size() * dto::Task::packed_size);
+            dto::pack_u64(res_body, static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+            dto::pack_u32(res_body, static_cast<kstd::u32>(tasks.size()));
+
+            for (const auto& task: tasks) {
+                task.pack(res_body);
+            }
+
+            res.status = 200;
+            res.set_content(res_body, FOX_PACKED_MIME_TYPE);
+            return;
+        }
+
+        if (get_response_format(req) == codec::WireFormat::JSON) {
+            // Skip the DOM entirely, the common case is a controller polling in a tight loop
+            thread_local fmt::memory_buffer buffer;
+            buffer.clear();
+
+            JsonWriter writer(buffer);
+            writer.begin_object();
+            writer.write_key("tasks");
+            write_tasks(writer, fetch_tasks(device, max_count));
+            writer.write_field("timestamp", static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+            writer.end_object();
+
+            res.status = 200;
+            res.set_content(buffer.data(), buffer.size(), FOX_JSON_MIME_TYPE);
+            return;
+        }
+
         auto res_body = nlohmann::json::object();
-        res_body["tasks"] = self.dequeue_and_compile();
+        res_body["tasks"] = compile_tasks(fetch_tasks(device, max_count));
         res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
-        res.status = 200;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
+        send_body(req, res, res_body);
     }
 
     auto Gateway::handle_setonline(const httplib::Request& req, httplib::Response& res) -> void {
-        auto req_body = nlohmann::json::parse(req.body);
+        auto req_body = parse_body(req);
 
         if (!req_body.is_object()) {
             send_error(res, 500, "Invalid request body type");
@@ -401,32 +1293,78 @@ namespace fox {
             return;
         }
 
-        auto& self = *s_instance;
-        const auto previous_state = static_cast<bool>(self._is_online);
-        const auto new_state = req_body["is_online"];
+        const auto device = resolve_device(req, res, true);
+
+        if (device == nullptr) {
+            return;
+        }
+
+        const auto new_state = static_cast<bool>(req_body["is_online"]);
 
         if (!new_state) { // Reset active session on disconnect
-            self._session_password_mutex.lock();
-            self._session_password = "";
-            self._session_password_mutex.unlock();
+            device->end_session();
         }
 
+        const auto previous_state = device->set_online(new_state);
+
         auto res_body = nlohmann::json::object();
         res_body["status"] = new_state != previous_state;
         res_body["previous"] = previous_state;
         res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
-        self._is_online = new_state;
-
-        res.status = 200;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
+        send_body(req, res, res_body);
     }
 
     auto Gateway::handle_setstate(const httplib::Request& req, httplib::Response& res) -> void {
         spdlog::debug("Received setstate request");
 
-        auto& self = *s_instance;
-        const auto req_body = nlohmann::json::parse(req.body);
+        if (get_request_format(req) == codec::WireFormat::PACKED) {
+            const auto packed = codec::split_packed(req.body);
+
+            if (!packed) {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            dto::DeviceState state{};
+            auto mask = dto::all_fields<dto::DeviceState>;
+
+            if (dto::DeviceState::is_packed_partial(packed->payload)) {
+                const auto partial_mask = state.unpack_partial(packed->payload);
+
+                if (!partial_mask) {
+                    send_error(res, 500, "Invalid request body type");
+                    return;
+                }
+
+                mask = *partial_mask;
+            }
+            else if (packed->payload.size() == dto::DeviceState::packed_size) {
+                state.unpack(packed->payload.data());
+            }
+            else {
+                send_error(res, 500, "Invalid request body type");
+                return;
+            }
+
+            if (!check_server_password(packed->password)) {
+                send_error(res, 401, "Invalid password");
+                return;
+            }
+
+            const auto device = resolve_device(req, res, true);
+
+            if (device == nullptr) {
+                return;
+            }
+
+            device->set_state(state, mask);
+
+            res.status = 200;
+            return;
+        }
+
+        const auto req_body = parse_body(req);
 
         if (!req_body.is_object()) {
             send_error(res, 500, "Invalid request body type");
@@ -450,9 +1388,16 @@ namespace fox {
             return;
         }
 
-        self._state_mutex.lock();
-        self._state.deserialize(state_obj);
-        self._state_mutex.unlock();
+        const auto device = resolve_device(req, res, true);
+
+        if (device == nullptr) {
+            return;
+        }
+
+        // Fields left out keep their value, so a controller only has to send what it measured
+        dto::DeviceState state{};
+        const auto mask = state.deserialize_partial(state_obj);
+        device->set_state(state, mask);
 
         res.status = 200;
     }
@@ -460,25 +1405,26 @@ namespace fox {
     auto Gateway::handle_newsession(const httplib::Request& req, httplib::Response& res) -> void {
         spdlog::debug("Received reset password request");
 
-        auto& self = *s_instance;
-        self._session_password_mutex.lock_shared();
+        const auto req_body = parse_body(req);
 
-        if (!self._session_password.empty()) {
-            send_error(res, 401, "Session already in progress");
+        if (!req_body.is_object()) {
+            send_error(res, 500, "Invalid request body type");
             return;
         }
 
-        self._session_password_mutex.unlock_shared();
+        if (!validate_server_password(req_body)) {
+            send_error(res, 401, "Invalid password");
+            return;
+        }
 
-        const auto req_body = nlohmann::json::parse(req.body);
+        const auto device = resolve_device(req, res, true);
 
-        if (!req_body.is_object()) {
-            send_error(res, 500, "Invalid request body type");
+        if (device == nullptr) {
             return;
         }
 
-        if (!validate_server_password(req_body)) {
-            send_error(res, 401, "Invalid password");
+        if (device->has_session()) {
+            send_error(res, 401, "Session already in progress");
             return;
         }
 
@@ -508,11 +1454,152 @@ namespace fox {
         res_body["password"] = session_password;
         res_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
 
-        self._session_password_mutex.lock();
-        self._session_password = session_password;
-        self._session_password_mutex.unlock();
+        device->start_session(session_password);
 
-        res.status = 200;
-        res.set_content(res_body.dump(), FOX_JSON_MIME_TYPE);
+        send_body(req, res, res_body);
+    }
+
+    // WebSocket control channel
+
+    auto Gateway::make_ws_message(std::string_view type, const nlohmann::json& body) noexcept -> std::string {
+        auto message = body;
+        message["type"] = type;
+        message["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        return message.dump();
+    }
+
+    auto Gateway::handle_websocket(WebSocket& socket) noexcept -> void {
+        spdlog::debug("Accepted WebSocket connection");
+        std::string message;
+
+        // The first message has to authenticate the connection, same as /authenticate
+        if (socket.receive(message, ws_auth_timeout) != ReceiveStatus::MESSAGE) {
+            socket.close(1008);
+            return;
+        }
+
+        const auto auth_body = nlohmann::json::parse(message, nullptr, false);
+
+        if (!auth_body.is_object()) {
+            socket.send(make_ws_message("error", {{"status", false}, {"error", "Invalid message"}}));
+            socket.close(1008);
+            return;
+        }
+
+        auto device_id = std::string(get_string_property(auth_body, "device"));
+
+        if (device_id.empty()) {
+            device_id = default_device_id;
+        }
+
+        const auto device = is_valid_device_id(device_id) ? find_device(device_id) : nullptr;
+
+        if (device == nullptr) {
+            socket.send(make_ws_message("error", {{"status", false}, {"error", "Unknown device"}}));
+            socket.close(1008);
+            return;
+        }
+
+        if (!device->check_session_token(get_string_property(auth_body, "token")) && !validate_client_password(*device, auth_body)) {
+            socket.send(make_ws_message("error", {{"status", false}, {"error", "Invalid password"}}));
+            socket.close(1008);
+            return;
+        }
+
+        auto stream = device->get_state_events().subscribe();
+
+        if (stream == nullptr) {
+            socket.send(make_ws_message("error", {{"status", false}, {"error", "Too many event subscribers"}}));
+            socket.close(1013);
+            return;
+        }
+
+        socket.send(make_ws_message("authenticated", {{"status", true}}));
+        stream->push(device->serialize_state());
+
+        // State changes are pushed from their own thread, so a slow reader can't delay them
+        std::thread writer([&socket, stream] {
+            while (const auto event = stream->wait_pop(event_keepalive_interval)) {
+                if (event->empty()) {
+                    continue;
+                }
+
+                if (!socket.send(fmt::format(R"({{"type":"state","state":{}}})", *event))) {
+                    break;
+                }
+            }
+
+            socket.close(1001); // Session was reset or we fell too far behind
+        });
+
+        while (_is_running && socket.is_open()) {
+            const auto status = socket.receive(message, ws_poll_interval);
+
+            if (status == ReceiveStatus::CLOSED) {
+                break;
+            }
+
+            if (status == ReceiveStatus::TIMEOUT) {
+                continue;
+            }
+
+            try {
+                handle_ws_message(*device, socket, message);
+            }
+            catch (const std::exception& error) {
+                socket.send(make_ws_message("error", {{"status", false}, {"error", error.what()}}));
+            }
+        }
+
+        stream->close();
+        writer.join();
+        device->get_state_events().unsubscribe(stream);
+        spdlog::debug("Closed WebSocket connection");
+    }
+
+    auto Gateway::handle_ws_message(Device& device, WebSocket& socket, const std::string& message) -> void {
+        // Same decoder as /enqueue, so malformed tasks are skipped the same way instead of half applied,
+        // and messages are dispatched without ever building a DOM
+        thread_local EnqueueParser parser;
+
+        if (!parser.parse(message, nlohmann::json::input_format_t::json) || !parser.is_object() || parser.get_message_type().empty()) {
+            socket.send(make_ws_message("error", {{"status", false}, {"error", "Invalid message"}}));
+            return;
+        }
+
+        const auto& type = parser.get_message_type();
+
+        if (type == "enqueue") {
+            if (!parser.is_tasks_array()) {
+                socket.send(make_ws_message("error", {{"status", false}, {"error", "Invalid tasks list type"}}));
+                return;
+            }
+
+            const auto task_count = parser.get_task_count();
+            kstd::usize queued_count = 0;
+
+            for (const auto& task: parser.get_tasks()) {
+                if (device.enqueue_task(task)) {
+                    ++queued_count;
+                }
+            }
+
+            _metrics.record_enqueue(queued_count, task_count - queued_count);
+
+            if (queued_count > 0 && !device.sync_tasks()) {
+                socket.send(make_ws_message("error", {{"status", false}, {"error", "Could not persist tasks"}}));
+                return;
+            }
+
+            socket.send(make_ws_message("enqueued", {{"status", queued_count == task_count}, {"queued", queued_count}}));
+            return;
+        }
+
+        if (type == "getstate") {
+            socket.send(make_ws_message("state", {{"state", device.compile_state()}}));
+            return;
+        }
+
+        socket.send(make_ws_message("error", {{"status", false}, {"error", "Unknown message type"}}));
     }
 }
\ No newline at end of file
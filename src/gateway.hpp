@@ -6,10 +6,15 @@
 #pragma once
 
 #include <thread>
+#include <memory>
+#include <algorithm>
 #include <string>
 #include <shared_mutex>
-#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <optional>
+#include <span>
 #include <functional>
 #include <exception>
 #include <kstd/types.hpp>
@@ -17,6 +22,13 @@
 #include <parallel_hashmap/phmap.h>
 
 #include "dto.hpp"
+#include "codec.hpp"
+#include "credential.hpp"
+#include "json_writer.hpp"
+#include "enqueue_parser.hpp"
+#include "device.hpp"
+#include "websocket.hpp"
+#include "metrics.hpp"
 
 namespace fox {
     struct AuthenticationError final : public std::runtime_error {
@@ -25,122 +37,271 @@ namespace fox {
         }
     };
 
+    struct GatewayConfig final {
+        std::string address;
+        kstd::u32 port; // 0 picks any free port
+        kstd::u32 worker_count; // HTTP worker threads of this gateway, 0 picks the httplib default
+        kstd::u32 backlog;
+        QueueConfig queue;
+        kstd::u32 max_devices;
+        kstd::u32 max_waiters;
+        kstd::u32 max_subscribers;
+        kstd::u32 event_buffer_size;
+        kstd::u32 ws_port;
+        kstd::u32 max_ws_connections;
+        kstd::u32 token_lifetime; // In seconds
+        std::string log_directory; // Empty to keep queued tasks in memory only
+        std::string spill_directory; // Empty to reject tasks once the backlog is full
+        std::string password;
+    };
+
+    enum class TokenStatus : kstd::u8 {
+        MISSING,
+        VALID,
+        INVALID
+    };
+
     class Gateway final {
-        static Gateway* s_instance;
+        using Handler = auto (Gateway::*)(const httplib::Request& req, httplib::Response& res) -> void;
+
+        // Sharded internally, so requests for different devices rarely contend on the same lock
+        using DeviceMap = phmap::parallel_flat_hash_map<std::string, std::shared_ptr<Device>,
+            phmap::Hash<std::string>, phmap::EqualTo<std::string>,
+            std::allocator<std::pair<const std::string, std::shared_ptr<Device>>>, 4, std::shared_mutex>;
+
+        static constexpr std::chrono::milliseconds max_fetch_wait{30000};
+        static constexpr std::chrono::milliseconds event_keepalive_interval{15000};
+        static constexpr std::chrono::milliseconds ws_auth_timeout{10000};
+        static constexpr std::chrono::milliseconds ws_poll_interval{1000};
+        static constexpr std::string_view default_device_id = "default";
+        static constexpr kstd::usize max_device_id_length = 64;
 
         httplib::Server _server;
 
         std::string _address;
         kstd::u32 _port;
-        kstd::u32 _backlog;
+        kstd::u32 _worker_count;
+        kstd::u32 _max_devices;
+        kstd::u32 _max_waiters;
+        kstd::u32 _max_streams; // Every event stream holds a worker for its whole lifetime, so they only get part of the pool
+        kstd::u32 _ws_port;
 
-        std::string _password;
-        std::shared_mutex _password_mutex;
-        std::string _session_password;
-        std::shared_mutex _session_password_mutex;
+        Credential _password;
 
         std::atomic_bool _is_running;
-        std::thread _command_thread;
+        std::thread _server_thread;
+        WebSocketServer _ws_server;
+        std::thread _ws_thread;
         phmap::flat_hash_map<std::string, std::function<void()>> _commands;
 
-        std::atomic_bool _is_online;
-        std::vector<dto::Task> _tasks;
-        std::shared_mutex _tasks_mutex;
-        dto::DeviceState _state;
-        std::shared_mutex _state_mutex;
-
-        std::atomic_size_t _total_task_count;
-        std::atomic_size_t _total_processed_count;
+        ResidenceTracker _residence_tracker;
+        DeviceConfig _device_config;
+        DeviceMap _devices;
+        std::atomic_uint32_t _fetch_waiter_count;
+        std::atomic_uint32_t _state_waiter_count;
+        std::atomic_uint32_t _stream_count;
+        Metrics _metrics;
+        TaskLogSyncer _task_log_syncer; // Declared after the devices, so it stops before their logs go away
 
         static auto generate_password(kstd::usize length = 16) noexcept -> std::string;
 
         static auto send_error(httplib::Response& res, kstd::i32 status, const std::string_view& message) noexcept -> void;
 
-        static auto validate_server_password(const nlohmann::json& json) -> bool;
+        static auto get_request_format(const httplib::Request& req) noexcept -> codec::WireFormat;
+
+        static auto get_response_format(const httplib::Request& req) noexcept -> codec::WireFormat;
+
+        static auto parse_body(const httplib::Request& req) -> nlohmann::json;
+
+        static auto send_body(const httplib::Request& req, httplib::Response& res, const nlohmann::json& body) -> void;
+
+        [[nodiscard]] auto check_server_password(std::string_view password) const noexcept -> bool;
+
+        /**
+         * Views a string property of the given body without copying it, empty if absent or not a string.
+         */
+        [[nodiscard]] static auto get_string_property(const nlohmann::json& json, const char* name) noexcept -> std::string_view;
+
+        /**
+         * @return The credential of a bearer Authorization header, empty for any other scheme, nothing without the header.
+         */
+        [[nodiscard]] static auto get_bearer_credential(const httplib::Request& req) noexcept -> std::optional<std::string_view>;
+
+        /**
+         * Checks the bearer token from the Authorization header, so requests can be rejected before parsing their body.
+         */
+        [[nodiscard]] static auto check_bearer_token(const httplib::Request& req, const Device& device) noexcept -> TokenStatus;
+
+        [[nodiscard]] auto validate_server_password(const nlohmann::json& json) const noexcept -> bool;
+
+        static auto validate_client_password(const Device& device, const nlohmann::json& json) noexcept -> bool;
+
+        [[nodiscard]] static auto is_valid_device_id(std::string_view id) noexcept -> bool;
+
+        [[nodiscard]] static auto make_etag(kstd::u64 version) noexcept -> std::string;
+
+        /**
+         * @return The state version named by the first entity tag of an If-None-Match header, if it is one of ours.
+         */
+        [[nodiscard]] static auto parse_etag(std::string_view header) noexcept -> std::optional<kstd::u64>;
 
-        static auto validate_client_password(const nlohmann::json& json) -> bool;
+        /**
+         * Looks up the device named by the device query parameter, which defaults to the default device.
+         * Only the controller may create devices, on failure the error response has already been sent.
+         */
+        auto resolve_device(const httplib::Request& req, httplib::Response& res, bool create) noexcept -> std::shared_ptr<Device>;
 
-        static auto command_loop(Gateway* self) noexcept -> void;
+        static auto make_ws_message(std::string_view type, const nlohmann::json& body) noexcept -> std::string;
 
         static auto handle_error(const httplib::Request& req, httplib::Response& res) -> void;
 
         // Web endpoints
 
-        static auto handle_status(const httplib::Request& req, httplib::Response& res) -> void;
+        auto handle_status(const httplib::Request& req, httplib::Response& res) -> void;
+
+        auto handle_metrics(const httplib::Request& req, httplib::Response& res) -> void;
+
+        auto handle_events(const httplib::Request& req, httplib::Response& res) -> void;
 
         // Client endpoints
 
-        static auto handle_authenticate(const httplib::Request& req, httplib::Response& res) -> void;
+        auto handle_authenticate(const httplib::Request& req, httplib::Response& res) -> void;
 
-        static auto handle_getstate(const httplib::Request& req, httplib::Response& res) -> void;
+        auto handle_getstate(const httplib::Request& req, httplib::Response& res) -> void;
 
-        static auto handle_enqueue(const httplib::Request& req, httplib::Response& res) -> void;
+        auto handle_enqueue(const httplib::Request& req, httplib::Response& res) -> void;
 
         // Server endpoints
 
-        static auto handle_fetch(const httplib::Request& req, httplib::Response& res) -> void;
+        auto handle_fetch(const httplib::Request& req, httplib::Response& res) -> void;
+
+        auto handle_setonline(const httplib::Request& req, httplib::Response& res) -> void;
+
+        auto handle_setstate(const httplib::Request& req, httplib::Response& res) -> void;
+
+        /**
+         * Applies a state report and online flag, then answers like /fetch, so a controller needs a single round-trip per cycle.
+         */
+        auto handle_sync(const httplib::Request& req, httplib::Response& res) -> void;
+
+        auto handle_newsession(const httplib::Request& req, httplib::Response& res) -> void;
+
+        // WebSocket control channel
+
+        auto handle_websocket(WebSocket& socket) noexcept -> void;
+
+        auto handle_ws_message(Device& device, WebSocket& socket, const std::string& message) -> void;
 
-        static auto handle_setonline(const httplib::Request& req, httplib::Response& res) -> void;
+        auto try_wait_for_tasks(Device& device, std::chrono::milliseconds timeout) noexcept -> void;
 
-        static auto handle_setstate(const httplib::Request& req, httplib::Response& res) -> void;
+        /**
+         * Reserves one of the event streams all devices share, on top of their per-device limits.
+         */
+        [[nodiscard]] auto try_open_stream() noexcept -> bool;
 
-        static auto handle_newsession(const httplib::Request& req, httplib::Response& res) -> void;
+        auto close_stream() noexcept -> void;
 
-        [[nodiscard]] auto dequeue_and_compile() noexcept -> nlohmann::json;
+        auto try_wait_for_state_change(Device& device, kstd::u64 version, std::chrono::milliseconds timeout) noexcept -> void;
+
+        [[nodiscard]] static auto compile_tasks(std::span<const dto::Task> tasks) noexcept -> nlohmann::json;
+
+        static auto write_tasks(JsonWriter& writer, std::span<const dto::Task> tasks) noexcept -> void;
 
         auto register_commands() noexcept -> void;
 
-        auto run_server() noexcept -> void;
+        /**
+         * Wraps a handler so every request it serves is counted and timed.
+         */
+        [[nodiscard]] auto instrument(Endpoint endpoint, Handler handler) noexcept -> httplib::Server::Handler;
 
-        public:
+        /**
+         * Takes up to the given number of tasks out of the queue of a device, recording the batch size.
+         */
+        [[nodiscard]] auto fetch_tasks(Device& device, kstd::usize max_count) noexcept -> std::span<const dto::Task>;
 
-        Gateway(std::string address, kstd::u32 port, kstd::u32 backlog, std::string password) noexcept;
+        /**
+         * Reads the optional max and wait_ms properties shared by /fetch and /sync.
+         * @return False if either is invalid, the error response has already been sent.
+         */
+        [[nodiscard]] static auto parse_fetch_limits(const nlohmann::json& req_body, httplib::Response& res, kstd::usize& max_count, std::chrono::milliseconds& timeout) -> bool;
 
-        ~Gateway() noexcept;
+        /**
+         * Narrows the task count and wait time of a fetch, a max of 0 leaves the count alone.
+         */
+        static auto apply_fetch_limits(kstd::u64 max, kstd::u64 wait_ms, kstd::usize& max_count, std::chrono::milliseconds& timeout) noexcept -> void;
 
-        inline auto enqueue_task(dto::Task task) noexcept -> bool {
-            _tasks_mutex.lock();
+        auto send_tasks(const httplib::Request& req, httplib::Response& res, Device& device, kstd::usize max_count) -> void;
 
-            if (_tasks.size() >= _backlog) {
-                _tasks_mutex.unlock();
-                return false;
-            }
+        /**
+         * Registers every device which has a task log left over from a previous run, so its tasks get delivered.
+         */
+        auto restore_logged_devices(const std::filesystem::path& directory) noexcept -> void;
 
-            _tasks.push_back(task);
-            _tasks_mutex.unlock();
+        auto register_endpoints() noexcept -> void;
 
-            ++_total_task_count;
-            return true;
-        }
+        public:
 
-        inline auto dequeue_task() noexcept -> std::optional<dto::Task> {
-            _tasks_mutex.lock();
-            const auto front = _tasks.begin();
+        explicit Gateway(GatewayConfig config) noexcept;
 
-            if (front == _tasks.end()) {
-                _tasks_mutex.unlock();
-                return std::nullopt;
-            }
+        Gateway(const Gateway&) = delete;
 
-            const auto result = *front;
-            _tasks.erase(front);
-            _tasks_mutex.unlock();
+        auto operator =(const Gateway&) -> Gateway& = delete;
 
-            ++_total_processed_count;
+        /**
+         * Stops the gateway if it is still running and waits for it to shut down.
+         */
+        ~Gateway() noexcept;
 
-            return {result};
+        /**
+         * Binds the HTTP and WebSocket ports and serves requests on background threads, returns right away.
+         * @return False if the HTTP port could not be bound.
+         */
+        [[nodiscard]] auto start() noexcept -> bool;
+
+        /**
+         * Wakes up everything waiting on a device and stops accepting requests, without waiting for the servers to finish.
+         */
+        auto stop() noexcept -> void;
+
+        /**
+         * Blocks until the servers have shut down after a call to stop.
+         */
+        auto wait() noexcept -> void;
+
+        /**
+         * Runs one of the console commands, like info or exit.
+         * @return False if there is no such command.
+         */
+        auto run_command(const std::string& command) noexcept -> bool;
+
+        [[nodiscard]] auto find_device(const std::string& id) const noexcept -> std::shared_ptr<Device>;
+
+        /**
+         * @return The device with the given ID, created on first use, or nullptr if the device limit is reached.
+         */
+        [[nodiscard]] auto get_or_create_device(const std::string& id) noexcept -> std::shared_ptr<Device>;
+
+        [[nodiscard]] inline auto get_device_count() const noexcept -> kstd::usize {
+            return _devices.size();
         }
 
         [[nodiscard]] inline auto get_address() const noexcept -> const std::string& {
             return _address;
         }
 
+        /**
+         * @return The port the HTTP server listens on, resolved once started if any free port was requested.
+         */
         [[nodiscard]] inline auto get_port() const noexcept -> kstd::u32 {
             return _port;
         }
 
+        [[nodiscard]] inline auto is_running() const noexcept -> bool {
+            return _is_running;
+        }
+
         [[nodiscard]] inline auto get_backlog() const noexcept -> kstd::u32 {
-            return _backlog;
+            return _device_config.backlog;
         }
     };
 }
\ No newline at end of file
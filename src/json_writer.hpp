@@ -0,0 +1,204 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <string_view>
+#include <type_traits>
+#include <fmt/format.h>
+#include <kstd/types.hpp>
+
+#include "dto.hpp"
+
+namespace fox {
+    /**
+     * Serializes JSON straight into a reusable buffer without building a DOM.
+     * DTOs are written through their field lists, so the output matches their DOM serialization.
+     */
+    class JsonWriter final {
+        fmt::memory_buffer& _buffer;
+        kstd::u64 _has_members; // One bit per nesting level, set once the container got its first member
+        kstd::u32 _depth;
+        bool _is_after_key;
+
+        inline auto append(std::string_view value) noexcept -> void {
+            _buffer.append(value.data(), value.data() + value.size());
+        }
+
+        inline auto begin_value() noexcept -> void {
+            if (_is_after_key) {
+                _is_after_key = false;
+                return;
+            }
+
+            if (_depth == 0) {
+                return;
+            }
+
+            const auto mask = 1ULL << (_depth - 1);
+
+            if ((_has_members & mask) != 0) {
+                _buffer.push_back(',');
+            }
+
+            _has_members |= mask;
+        }
+
+        inline auto write_string(std::string_view value) noexcept -> void {
+            constexpr std::string_view hex_digits = "0123456789abcdef";
+            _buffer.push_back('"');
+
+            for (const auto c: value) {
+                switch (c) {
+                    case '"':
+                        append("\\\"");
+                        break;
+                    case '\\':
+                        append("\\\\");
+                        break;
+                    case '\n':
+                        append("\\n");
+                        break;
+                    case '\r':
+                        append("\\r");
+                        break;
+                    case '\t':
+                        append("\\t");
+                        break;
+                    default:
+                        if (static_cast<kstd::u8>(c) < 0x20) {
+                            append("\\u00");
+                            _buffer.push_back(hex_digits[(c >> 4) & 0xF]);
+                            _buffer.push_back(hex_digits[c & 0xF]);
+                        }
+                        else {
+                            _buffer.push_back(c);
+                        }
+                        break;
+                }
+            }
+
+            _buffer.push_back('"');
+        }
+
+        public:
+
+        explicit JsonWriter(fmt::memory_buffer& buffer) noexcept:
+                _buffer(buffer),
+                _has_members(0),
+                _depth(0),
+                _is_after_key(false) {
+        }
+
+        inline auto begin_object() noexcept -> void {
+            begin_value();
+            _buffer.push_back('{');
+            _has_members &= ~(1ULL << _depth++);
+        }
+
+        inline auto end_object() noexcept -> void {
+            --_depth;
+            _buffer.push_back('}');
+        }
+
+        inline auto begin_array() noexcept -> void {
+            begin_value();
+            _buffer.push_back('[');
+            _has_members &= ~(1ULL << _depth++);
+        }
+
+        inline auto end_array() noexcept -> void {
+            --_depth;
+            _buffer.push_back(']');
+        }
+
+        inline auto write_key(std::string_view name) noexcept -> void {
+            begin_value();
+            write_string(name);
+            _buffer.push_back(':');
+            _is_after_key = true;
+        }
+
+        // Constrained, so string literals don't decay into bools
+        template<typename T> requires(std::is_same_v<T, bool>)
+        inline auto write_value(T value) noexcept -> void {
+            begin_value();
+            append(value ? "true" : "false");
+        }
+
+        inline auto write_value(std::string_view value) noexcept -> void {
+            begin_value();
+            write_string(value);
+        }
+
+        template<typename T> requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+        inline auto write_value(T value) noexcept -> void {
+            begin_value();
+
+            if constexpr (std::is_signed_v<T>) {
+                const fmt::format_int formatted(static_cast<long long>(value));
+                append({formatted.data(), formatted.size()});
+            }
+            else {
+                const fmt::format_int formatted(static_cast<unsigned long long>(value));
+                append({formatted.data(), formatted.size()});
+            }
+        }
+
+        template<typename T> requires(std::is_enum_v<T>)
+        inline auto write_value(T value) noexcept -> void {
+            write_value(static_cast<std::underlying_type_t<T>>(value));
+        }
+
+        template<typename T>
+        inline auto write_field(std::string_view name, const T& value) noexcept -> void {
+            write_key(name);
+            write_value(value);
+        }
+
+        /**
+         * Writes all fields of the given DTO into the object which is currently open.
+         */
+        template<typename T>
+        inline auto write_fields(const T& value) noexcept -> void {
+            dto::for_each_field(value, [this](std::string_view name, const auto& member) {
+                write_field(name, member);
+            });
+        }
+
+        /**
+         * Writes only the masked fields of the given DTO.
+         */
+        template<typename T>
+        inline auto write_fields(const T& value, dto::FieldMask mask) noexcept -> void {
+            dto::for_each_field_indexed(value, [this, mask](kstd::usize index, std::string_view name, const auto& member) {
+                if ((mask >> index & 1) != 0) {
+                    write_field(name, member);
+                }
+            });
+        }
+
+        template<typename T>
+        inline auto write_object(const T& value) noexcept -> void {
+            begin_object();
+            write_fields(value);
+            end_object();
+        }
+
+        inline auto write_object(const dto::Task& task) noexcept -> void {
+            switch (task.type) {
+                case dto::TaskType::POWER:
+                    write_object(task.power);
+                    break;
+                case dto::TaskType::SPEED:
+                    write_object(task.speed);
+                    break;
+                case dto::TaskType::MODE:
+                    write_object(task.mode);
+                    break;
+            }
+        }
+    };
+}
\ No newline at end of file
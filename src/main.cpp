@@ -3,8 +3,12 @@
  * @since 05/04/2023
  */
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
+#include <filesystem>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <httplib.h>
@@ -24,8 +28,22 @@ auto main(int num_args, char** args) -> int {
         ("v,version", "Show version information")
         ("V,verbose", "Enable verbose logging")
         ("a,address", "Specify the address on which to listen for HTTP requests", cxxopts::value<std::string>()->default_value("127.0.0.1"))
-        ("p,port", "Specify the port on which to listen for HTTP requests", cxxopts::value<kstd::u32>()->default_value("8080"))
-        ("b,backlog", "Specify the maximum of tasks that can be queued up internally", cxxopts::value<kstd::u32>()->default_value("500"))
+        ("p,port", "Specify the port on which to listen for HTTP requests, shards listen on the ports following it", cxxopts::value<kstd::u32>()->default_value("8080"))
+        ("t,threads", "Specify how many HTTP worker threads every shard gets, 0 picks the default", cxxopts::value<kstd::u32>()->default_value("0"))
+        ("shards", "Specify how many independent gateways to run in this process, each with its own port, devices and workers", cxxopts::value<kstd::u32>()->default_value("1"))
+        ("b,backlog", "Specify the maximum of tasks that can be queued up internally per device", cxxopts::value<kstd::u32>()->default_value("500"))
+        ("priorities", "Specify the priority lane of every task type, lane 0 is drained first", cxxopts::value<std::string>()->default_value("power=0,mode=0,speed=1"))
+        ("lane-weights", "Specify how the backlog is split between the priority lanes, by relative weight", cxxopts::value<std::string>()->default_value("1,1,1"))
+        ("conflate", "Specify the task types of which only the latest queued value is delivered, like speed,mode", cxxopts::value<std::string>()->default_value(""))
+        ("d,max-devices", "Specify the maximum of devices that may be registered at the same time", cxxopts::value<kstd::u32>()->default_value("4096"))
+        ("w,max-waiters", "Specify the maximum of fetch requests that may wait for tasks, and of state requests that may wait for a change, at the same time", cxxopts::value<kstd::u32>()->default_value("4"))
+        ("s,max-subscribers", "Specify the maximum of concurrent event stream subscribers per device, all devices together get at most half the HTTP workers", cxxopts::value<kstd::u32>()->default_value("64"))
+        ("event-buffer", "Specify how many events may be buffered for a subscriber before it is dropped", cxxopts::value<kstd::u32>()->default_value("32"))
+        ("ws-port", "Specify the port on which to accept WebSocket connections, 0 disables the WebSocket channel", cxxopts::value<kstd::u32>()->default_value("0"))
+        ("ws-max-connections", "Specify the maximum of concurrent WebSocket connections", cxxopts::value<kstd::u32>()->default_value("64"))
+        ("token-lifetime", "Specify for how many seconds a session token issued by /authenticate stays valid", cxxopts::value<kstd::u32>()->default_value("900"))
+        ("wal-dir", "Specify a directory in which to log queued tasks so they survive a restart, empty keeps them in memory only", cxxopts::value<std::string>()->default_value(""))
+        ("spill-dir", "Specify a directory to which tasks overflowing the backlog are spilled, empty rejects them instead", cxxopts::value<std::string>()->default_value(""))
         ("P,password", "Specify the password with which to authenticate against the endpoint for queueing tasks", cxxopts::value<std::string>());
     // @formatter:on
 
@@ -57,17 +75,99 @@ auto main(int num_args, char** args) -> int {
         return 0;
     }
 
-    const auto address = options["address"].as<std::string>();
-    const auto port = options["port"].as<kstd::u32>();
-    const auto backlog = options["backlog"].as<kstd::u32>();
-    const auto password = options["password"].as<std::string>();
+    const auto queue = fox::QueueConfig::parse(options["priorities"].as<std::string>(), options["lane-weights"].as<std::string>(), options["conflate"].as<std::string>());
 
-    if (password.size() < 10) {
+    if (!queue) {
+        spdlog::error("Malformed task priorities, lane weights or conflated task types");
+        return 1;
+    }
+
+    fox::GatewayConfig config{
+        options["address"].as<std::string>(),
+        options["port"].as<kstd::u32>(),
+        options["threads"].as<kstd::u32>(),
+        options["backlog"].as<kstd::u32>(),
+        *queue,
+        options["max-devices"].as<kstd::u32>(),
+        options["max-waiters"].as<kstd::u32>(),
+        options["max-subscribers"].as<kstd::u32>(),
+        options["event-buffer"].as<kstd::u32>(),
+        options["ws-port"].as<kstd::u32>(),
+        options["ws-max-connections"].as<kstd::u32>(),
+        options["token-lifetime"].as<kstd::u32>(),
+        options["wal-dir"].as<std::string>(),
+        options["spill-dir"].as<std::string>(),
+        options["password"].as<std::string>()
+    };
+
+    if (config.password.size() < 10) {
         spdlog::error("Password has to be at least 10 characters");
         return 1;
     }
 
-    fox::Gateway gateway(address, port, backlog, password);
+    const auto shard_count = options["shards"].as<kstd::u32>();
+
+    if (shard_count == 0) {
+        spdlog::error("At least one shard is required");
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<fox::Gateway>> gateways;
+
+    for (kstd::u32 shard = 0; shard < shard_count; ++shard) {
+        auto shard_config = config;
+
+        if (shard_count > 1) {
+            // Shards share nothing, so neither ports nor directories may overlap
+            shard_config.port = config.port == 0 ? 0 : config.port + shard;
+            shard_config.ws_port = config.ws_port == 0 ? 0 : config.ws_port + shard;
+
+            if (!config.log_directory.empty()) {
+                shard_config.log_directory = (std::filesystem::path(config.log_directory) / fmt::format("shard-{}", shard)).string();
+            }
+
+            if (!config.spill_directory.empty()) {
+                shard_config.spill_directory = (std::filesystem::path(config.spill_directory) / fmt::format("shard-{}", shard)).string();
+            }
+        }
+
+        auto gateway = std::make_unique<fox::Gateway>(std::move(shard_config));
+
+        if (!gateway->start()) {
+            return 1;
+        }
+
+        gateways.push_back(std::move(gateway));
+    }
+
+    const auto is_any_running = [&gateways] {
+        return std::any_of(gateways.begin(), gateways.end(), [](const auto& gateway) {
+            return gateway->is_running();
+        });
+    };
+
+    // Console commands apply to every shard
+    std::string command;
+
+    while (is_any_running() && std::getline(std::cin, command)) {
+        if (command.empty()) {
+            continue;
+        }
+
+        auto is_known = false;
+
+        for (auto& gateway: gateways) {
+            is_known = gateway->run_command(command) || is_known;
+        }
+
+        if (!is_known) {
+            spdlog::info("Unrecognized command, try help");
+        }
+    }
+
+    for (auto& gateway: gateways) {
+        gateway->wait();
+    }
 
     return 0;
 }
\ No newline at end of file
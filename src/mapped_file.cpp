@@ -0,0 +1,134 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include "mapped_file.hpp"
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fox {
+    #ifdef PLATFORM_WINDOWS
+    MappedFile::MappedFile() noexcept:
+            _file(INVALID_HANDLE_VALUE),
+            _mapping(nullptr),
+            _data(nullptr),
+            _size(0) {
+    }
+
+    auto MappedFile::open(const std::filesystem::path& path, kstd::usize size) noexcept -> bool {
+        close();
+        _file = ::CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (_file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        // Mapping past the end of the file grows it, the new space reads as zeroes
+        const auto high = static_cast<DWORD>(static_cast<kstd::u64>(size) >> 32);
+        const auto low = static_cast<DWORD>(size & 0xFFFFFFFF);
+        _mapping = ::CreateFileMappingW(_file, nullptr, PAGE_READWRITE, high, low, nullptr);
+
+        if (_mapping == nullptr) {
+            close();
+            return false;
+        }
+
+        _data = static_cast<kstd::u8*>(::MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+
+        if (_data == nullptr) {
+            close();
+            return false;
+        }
+
+        _size = size;
+        return true;
+    }
+
+    auto MappedFile::sync() noexcept -> bool {
+        return ::FlushViewOfFile(_data, _size) != 0 && ::FlushFileBuffers(_file) != 0;
+    }
+
+    auto MappedFile::close() noexcept -> void {
+        if (_data != nullptr) {
+            ::UnmapViewOfFile(_data);
+            _data = nullptr;
+        }
+
+        if (_mapping != nullptr) {
+            ::CloseHandle(_mapping);
+            _mapping = nullptr;
+        }
+
+        if (_file != INVALID_HANDLE_VALUE) {
+            ::CloseHandle(_file);
+            _file = INVALID_HANDLE_VALUE;
+        }
+
+        _size = 0;
+    }
+    #else
+    MappedFile::MappedFile() noexcept:
+            _file(-1),
+            _data(nullptr),
+            _size(0) {
+    }
+
+    auto MappedFile::open(const std::filesystem::path& path, kstd::usize size) noexcept -> bool {
+        close();
+        _file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+        if (_file < 0) {
+            return false;
+        }
+
+        struct stat status{};
+
+        // Growing a file through ftruncate leaves a hole which reads as zeroes
+        if (::fstat(_file, &status) != 0 || (static_cast<kstd::usize>(status.st_size) < size && ::ftruncate(_file, static_cast<off_t>(size)) != 0)) {
+            close();
+            return false;
+        }
+
+        auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+
+        if (data == MAP_FAILED) {
+            close();
+            return false;
+        }
+
+        _data = static_cast<kstd::u8*>(data);
+        _size = size;
+        return true;
+    }
+
+    auto MappedFile::sync() noexcept -> bool {
+        return ::msync(_data, _size, MS_SYNC) == 0;
+    }
+
+    auto MappedFile::close() noexcept -> void {
+        if (_data != nullptr) {
+            ::munmap(_data, _size);
+            _data = nullptr;
+        }
+
+        if (_file >= 0) {
+            ::close(_file);
+            _file = -1;
+        }
+
+        _size = 0;
+    }
+    #endif
+
+    MappedFile::~MappedFile() noexcept {
+        close();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * A file of fixed size mapped read-write into memory, created and zero-filled if it doesn't exist.
+     * Writes land in the page cache, sync() forces them onto the disk.
+     */
+    class MappedFile final {
+        #ifdef PLATFORM_WINDOWS
+        void* _file;
+        void* _mapping;
+        #else
+        kstd::i32 _file;
+        #endif
+        kstd::u8* _data;
+        kstd::usize _size;
+
+        auto close() noexcept -> void;
+
+        public:
+
+        MappedFile() noexcept;
+
+        ~MappedFile() noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+
+        auto operator =(const MappedFile&) -> MappedFile& = delete;
+
+        [[nodiscard]] auto open(const std::filesystem::path& path, kstd::usize size) noexcept -> bool;
+
+        /**
+         * Blocks until everything written to the mapping so far is durable.
+         */
+        [[nodiscard]] auto sync() noexcept -> bool;
+
+        [[nodiscard]] inline auto is_open() const noexcept -> bool {
+            return _data != nullptr;
+        }
+
+        [[nodiscard]] inline auto get_data() const noexcept -> kstd::u8* {
+            return _data;
+        }
+
+        [[nodiscard]] inline auto get_size() const noexcept -> kstd::usize {
+            return _size;
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "metrics.hpp"
+
+namespace fox {
+    namespace {
+        constexpr std::array<std::string_view, endpoint_count> endpoint_names = {
+            "/status", "/metrics", "/events", "/getstate", "/authenticate", "/enqueue", "/fetch", "/setstate", "/setonline", "/newsession", "/sync"
+        };
+
+        auto write_header(fmt::memory_buffer& buffer, std::string_view name, std::string_view type, std::string_view help) noexcept -> void {
+            fmt::format_to(std::back_inserter(buffer), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+        }
+    }
+
+    Histogram::Histogram() noexcept:
+            _shards(std::make_unique<std::array<Shard, metric_shard_count>>()) {
+    }
+
+    auto Histogram::get_snapshot() const noexcept -> Snapshot {
+        Snapshot snapshot{};
+
+        for (const auto& shard: *_shards) {
+            for (kstd::usize i = 0; i < bucket_count; ++i) {
+                const auto count = shard.buckets[i].load(std::memory_order_relaxed);
+                snapshot.buckets[i] += count;
+                snapshot.count += count;
+            }
+
+            snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        }
+
+        return snapshot;
+    }
+
+    auto Histogram::get_quantile(double quantile) const noexcept -> kstd::u64 {
+        const auto snapshot = get_snapshot();
+
+        if (snapshot.count == 0) {
+            return 0;
+        }
+
+        const auto rank = std::max<kstd::u64>(static_cast<kstd::u64>(std::ceil(quantile * static_cast<double>(snapshot.count))), 1);
+        kstd::u64 count = 0;
+
+        for (kstd::usize i = 0; i < bucket_count; ++i) {
+            count += snapshot.buckets[i];
+
+            if (count >= rank) {
+                return get_upper_bound(i);
+            }
+        }
+
+        return get_upper_bound(bucket_count - 1);
+    }
+
+    auto Histogram::get_count() const noexcept -> kstd::u64 {
+        return get_snapshot().count;
+    }
+
+    auto Histogram::write(fmt::memory_buffer& buffer, std::string_view name, std::string_view labels, double unit) const noexcept -> void {
+        const auto snapshot = get_snapshot();
+        const auto& buckets = snapshot.buckets;
+        const auto sum = snapshot.sum;
+
+        const auto* last = std::find_if(buckets.rbegin(), buckets.rend(), [](kstd::u64 count) {
+            return count > 0;
+        }).base();
+
+        const auto separator = labels.empty() ? "" : ",";
+        const auto series = labels.empty() ? std::string() : fmt::format("{{{}}}", labels);
+        auto out = std::back_inserter(buffer);
+        kstd::u64 count = 0;
+
+        for (const auto* bucket = buckets.data(); bucket != last; ++bucket) {
+            count += *bucket;
+            const auto upper_bound = static_cast<double>(get_upper_bound(static_cast<kstd::usize>(bucket - buckets.data()))) / unit;
+            fmt::format_to(out, "{}_bucket{{{}{}le=\"{}\"}} {}\n", name, labels, separator, upper_bound, count);
+        }
+
+        fmt::format_to(out, "{}_bucket{{{}{}le=\"+Inf\"}} {}\n", name, labels, separator, count);
+        fmt::format_to(out, "{}_sum{} {}\n", name, series, static_cast<double>(sum) / unit);
+        fmt::format_to(out, "{}_count{} {}\n", name, series, count);
+    }
+
+    auto Metrics::record_request(Endpoint endpoint, kstd::i32 status, std::chrono::microseconds latency, kstd::usize received_bytes, kstd::usize sent_bytes) noexcept -> void {
+        auto& metrics = _endpoints[static_cast<kstd::usize>(endpoint)];
+        const auto status_index = static_cast<kstd::usize>(std::find(tracked_statuses.begin(), tracked_statuses.end(), status) - tracked_statuses.begin());
+
+        metrics.responses[status_index].add();
+        metrics.latency.record(static_cast<kstd::u64>(std::max<std::chrono::microseconds::rep>(latency.count(), 0)));
+        metrics.received_bytes.add(received_bytes);
+        metrics.sent_bytes.add(sent_bytes);
+    }
+
+    auto Metrics::write(fmt::memory_buffer& buffer) const noexcept -> void {
+        auto out = std::back_inserter(buffer);
+
+        write_header(buffer, "fox_http_responses_total", "counter", "HTTP responses by endpoint and status");
+
+        for (kstd::usize i = 0; i < endpoint_count; ++i) {
+            for (kstd::usize j = 0; j < _endpoints[i].responses.size(); ++j) {
+                const auto count = _endpoints[i].responses[j].load();
+
+                if (count == 0) {
+                    continue;
+                }
+
+                if (j < tracked_statuses.size()) {
+                    fmt::format_to(out, "fox_http_responses_total{{endpoint=\"{}\",status=\"{}\"}} {}\n", endpoint_names[i], tracked_statuses[j], count);
+                }
+                else {
+                    fmt::format_to(out, "fox_http_responses_total{{endpoint=\"{}\",status=\"other\"}} {}\n", endpoint_names[i], count);
+                }
+            }
+        }
+
+        write_header(buffer, "fox_http_request_duration_seconds", "histogram", "Time spent in the handler of every endpoint");
+
+        for (kstd::usize i = 0; i < endpoint_count; ++i) {
+            _endpoints[i].latency.write(buffer, "fox_http_request_duration_seconds", fmt::format("endpoint=\"{}\"", endpoint_names[i]), 1e6);
+        }
+
+        write_header(buffer, "fox_http_received_bytes_total", "counter", "Request body bytes by endpoint");
+
+        for (kstd::usize i = 0; i < endpoint_count; ++i) {
+            fmt::format_to(out, "fox_http_received_bytes_total{{endpoint=\"{}\"}} {}\n", endpoint_names[i], _endpoints[i].received_bytes.load());
+        }
+
+        write_header(buffer, "fox_http_sent_bytes_total", "counter", "Response body bytes by endpoint, event streams excluded");
+
+        for (kstd::usize i = 0; i < endpoint_count; ++i) {
+            fmt::format_to(out, "fox_http_sent_bytes_total{{endpoint=\"{}\"}} {}\n", endpoint_names[i], _endpoints[i].sent_bytes.load());
+        }
+
+        write_header(buffer, "fox_tasks_queued_total", "counter", "Tasks accepted into a queue");
+        fmt::format_to(out, "fox_tasks_queued_total {}\n", _queued_tasks.load());
+
+        write_header(buffer, "fox_tasks_rejected_total", "counter", "Tasks rejected because their queue was full or they were malformed");
+        fmt::format_to(out, "fox_tasks_rejected_total {}\n", _rejected_tasks.load());
+
+        write_header(buffer, "fox_tasks_fetched_total", "counter", "Tasks handed out to controllers");
+        fmt::format_to(out, "fox_tasks_fetched_total {}\n", _fetched_tasks.load());
+
+        write_header(buffer, "fox_tasks_lost_total", "counter", "Tasks taken out of the queue for an event stream which broke before they were sent");
+        fmt::format_to(out, "fox_tasks_lost_total {}\n", _lost_tasks.load());
+
+        write_header(buffer, "fox_fetch_batch_size", "histogram", "Tasks handed out per fetch");
+        _fetch_batch_sizes.write(buffer, "fox_fetch_batch_size", "", 1);
+    }
+}
\ No newline at end of file
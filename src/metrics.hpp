@@ -0,0 +1,192 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <fmt/format.h>
+#include <kstd/types.hpp>
+
+namespace fox {
+    static constexpr kstd::usize metric_shard_count = 16;
+
+    /**
+     * Spreads threads round-robin over the shards of every counter and histogram,
+     * so concurrent updates rarely touch the same cache line.
+     */
+    [[nodiscard]] inline auto get_metric_shard() noexcept -> kstd::usize {
+        static std::atomic_size_t next_shard{0};
+        thread_local const auto shard = next_shard.fetch_add(1, std::memory_order_relaxed) % metric_shard_count;
+        return shard;
+    }
+
+    class ShardedCounter final {
+        struct Shard final {
+            alignas(64) std::atomic<kstd::u64> value;
+        };
+
+        std::array<Shard, metric_shard_count> _shards{};
+
+        public:
+
+        inline auto add(kstd::u64 value = 1) noexcept -> void {
+            _shards[get_metric_shard()].value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto load() const noexcept -> kstd::u64 {
+            kstd::u64 value = 0;
+
+            for (const auto& shard: _shards) {
+                value += shard.value.load(std::memory_order_relaxed);
+            }
+
+            return value;
+        }
+    };
+
+    /**
+     * Log-linear histogram of integer values up to 2^32: exact below 4,
+     * above that every power of two is split into 4 equally wide buckets, so the relative error stays below 25%.
+     */
+    class Histogram final {
+        public:
+
+        static constexpr kstd::u32 sub_bucket_bits = 2;
+        static constexpr kstd::usize sub_bucket_count = 1 << sub_bucket_bits;
+        static constexpr kstd::usize bucket_count = sub_bucket_count * (32 - sub_bucket_bits + 1);
+
+        private:
+
+        struct Shard final {
+            alignas(64) std::array<std::atomic<kstd::u64>, bucket_count> buckets;
+            std::atomic<kstd::u64> sum;
+        };
+
+        struct Snapshot final {
+            std::array<kstd::u64, bucket_count> buckets;
+            kstd::u64 sum;
+            kstd::u64 count;
+        };
+
+        std::unique_ptr<std::array<Shard, metric_shard_count>> _shards; // Kept off the stack, it's quite big
+
+        [[nodiscard]] static constexpr auto get_bucket(kstd::u64 value) noexcept -> kstd::usize {
+            if (value < sub_bucket_count) {
+                return static_cast<kstd::usize>(value);
+            }
+
+            if (value > 0xFFFFFFFF) {
+                return bucket_count - 1;
+            }
+
+            const auto magnitude = static_cast<kstd::u32>(std::bit_width(value)) - 1 - sub_bucket_bits;
+            const auto sub_bucket = static_cast<kstd::usize>(value >> magnitude) & (sub_bucket_count - 1);
+            return sub_bucket_count * (magnitude + 1) + sub_bucket;
+        }
+
+        /**
+         * @return The largest value which falls into the given bucket.
+         */
+        [[nodiscard]] static constexpr auto get_upper_bound(kstd::usize bucket) noexcept -> kstd::u64 {
+            if (bucket < sub_bucket_count) {
+                return bucket;
+            }
+
+            const auto magnitude = bucket / sub_bucket_count - 1;
+            const auto lower_bound = static_cast<kstd::u64>(sub_bucket_count + bucket % sub_bucket_count) << magnitude;
+            return lower_bound + (1ULL << magnitude) - 1;
+        }
+
+        [[nodiscard]] auto get_snapshot() const noexcept -> Snapshot;
+
+        public:
+
+        Histogram() noexcept;
+
+        inline auto record(kstd::u64 value) noexcept -> void {
+            auto& shard = (*_shards)[get_metric_shard()];
+            shard.buckets[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * Writes the series of this histogram in the Prometheus text format, with every bound and the sum divided by unit.
+         * Buckets above the highest one in use are left out.
+         */
+        auto write(fmt::memory_buffer& buffer, std::string_view name, std::string_view labels, double unit) const noexcept -> void;
+
+        /**
+         * @return The upper bound of the bucket holding the given quantile, like 0.99, or 0 if nothing was recorded yet.
+         */
+        [[nodiscard]] auto get_quantile(double quantile) const noexcept -> kstd::u64;
+
+        [[nodiscard]] auto get_count() const noexcept -> kstd::u64;
+    };
+
+    enum class Endpoint : kstd::u8 {
+        STATUS,
+        METRICS,
+        EVENTS,
+        GETSTATE,
+        AUTHENTICATE,
+        ENQUEUE,
+        FETCH,
+        SETSTATE,
+        SETONLINE,
+        NEWSESSION,
+        SYNC
+    };
+
+    static constexpr kstd::usize endpoint_count = 11;
+
+    /**
+     * Request, queue and traffic metrics of the gateway, exposed by /metrics.
+     */
+    class Metrics final {
+        static constexpr std::array<kstd::i32, 6> tracked_statuses = {200, 304, 401, 404, 500, 503}; // Anything else counts as "other"
+
+        struct EndpointMetrics final {
+            std::array<ShardedCounter, tracked_statuses.size() + 1> responses;
+            Histogram latency; // In microseconds
+            ShardedCounter received_bytes;
+            ShardedCounter sent_bytes;
+        };
+
+        std::array<EndpointMetrics, endpoint_count> _endpoints;
+        ShardedCounter _queued_tasks;
+        ShardedCounter _rejected_tasks;
+        ShardedCounter _fetched_tasks;
+        ShardedCounter _lost_tasks;
+        Histogram _fetch_batch_sizes;
+
+        public:
+
+        auto record_request(Endpoint endpoint, kstd::i32 status, std::chrono::microseconds latency, kstd::usize received_bytes, kstd::usize sent_bytes) noexcept -> void;
+
+        inline auto record_enqueue(kstd::usize queued_count, kstd::usize rejected_count) noexcept -> void {
+            _queued_tasks.add(queued_count);
+
+            if (rejected_count > 0) {
+                _rejected_tasks.add(rejected_count);
+            }
+        }
+
+        inline auto record_fetch(kstd::usize task_count) noexcept -> void {
+            _fetched_tasks.add(task_count);
+            _fetch_batch_sizes.record(task_count);
+        }
+
+        inline auto record_lost(kstd::usize task_count) noexcept -> void {
+            _lost_tasks.add(task_count);
+        }
+
+        auto write(fmt::memory_buffer& buffer) const noexcept -> void;
+    };
+}
\ No newline at end of file
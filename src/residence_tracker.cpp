@@ -0,0 +1,72 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include "residence_tracker.hpp"
+#include "task_queue.hpp"
+
+namespace fox {
+    ResidenceTracker::ResidenceTracker() noexcept:
+            _slow_threshold(0),
+            _window_end(0) {
+    }
+
+    auto ResidenceTracker::record(std::string_view device, std::span<const dto::Task> tasks, std::span<const kstd::u64> enqueue_times) noexcept -> void {
+        const auto now = TaskQueue::get_timestamp();
+
+        for (kstd::usize i = 0; i < tasks.size(); ++i) {
+            const auto residence_time = now - std::min(enqueue_times[i], now);
+            _residence_times.record(residence_time);
+
+            if (residence_time > _slow_threshold.load(std::memory_order_relaxed) || now >= _window_end.load(std::memory_order_relaxed)) {
+                record_slow_task(device, tasks[i], residence_time, now);
+            }
+        }
+    }
+
+    auto ResidenceTracker::record_slow_task(std::string_view device, const dto::Task& task, kstd::u64 residence_time, kstd::u64 now) noexcept -> void {
+        std::lock_guard lock(_slow_mutex);
+
+        // Otherwise a single stall would keep the list to itself forever
+        if (now >= _window_end.load(std::memory_order_relaxed)) {
+            _previous_slow_tasks = std::move(_slow_tasks);
+            _slow_tasks.clear();
+            _window_end.store(now + static_cast<kstd::u64>(slow_task_window.count()), std::memory_order_relaxed);
+        }
+
+        if (_slow_tasks.size() == max_slow_tasks && residence_time <= _slow_tasks.back().residence_time) {
+            return;
+        }
+
+        const auto position = std::find_if(_slow_tasks.begin(), _slow_tasks.end(), [residence_time](const SlowTask& slow_task) {
+            return slow_task.residence_time < residence_time;
+        });
+
+        const auto timestamp = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        _slow_tasks.insert(position, SlowTask{std::string(device), task, residence_time, timestamp});
+
+        if (_slow_tasks.size() > max_slow_tasks) {
+            _slow_tasks.pop_back();
+        }
+
+        _slow_threshold.store(_slow_tasks.size() == max_slow_tasks ? _slow_tasks.back().residence_time : 0, std::memory_order_relaxed);
+    }
+
+    auto ResidenceTracker::get_slow_tasks() noexcept -> std::vector<SlowTask> {
+        std::lock_guard lock(_slow_mutex);
+        auto slow_tasks = _slow_tasks;
+        slow_tasks.insert(slow_tasks.end(), _previous_slow_tasks.begin(), _previous_slow_tasks.end());
+
+        std::stable_sort(slow_tasks.begin(), slow_tasks.end(), [](const SlowTask& a, const SlowTask& b) {
+            return a.residence_time > b.residence_time;
+        });
+
+        if (slow_tasks.size() > max_slow_tasks) {
+            slow_tasks.resize(max_slow_tasks);
+        }
+
+        return slow_tasks;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <kstd/types.hpp>
+
+#include "dto.hpp"
+#include "metrics.hpp"
+
+namespace fox {
+    struct SlowTask final {
+        std::string device;
+        dto::Task task;
+        kstd::u64 residence_time; // In microseconds
+        kstd::u64 timestamp; // When it was handed out, in milliseconds since the epoch
+    };
+
+    /**
+     * Tracks how long tasks wait between being enqueued and being handed out,
+     * in a histogram and as a short list of the slowest tasks of the last minute or two.
+     * Only tasks slower than the current list take a lock, everything else is a histogram update.
+     */
+    class ResidenceTracker final {
+        static constexpr kstd::usize max_slow_tasks = 16;
+        static constexpr std::chrono::microseconds slow_task_window{std::chrono::minutes(1)};
+
+        Histogram _residence_times; // In microseconds
+        std::atomic<kstd::u64> _slow_threshold; // Residence time a task has to exceed to make it into the list
+        std::atomic<kstd::u64> _window_end;
+        std::mutex _slow_mutex;
+        std::vector<SlowTask> _slow_tasks; // Sorted by residence time, slowest first
+        std::vector<SlowTask> _previous_slow_tasks; // Of the previous window
+
+        auto record_slow_task(std::string_view device, const dto::Task& task, kstd::u64 residence_time, kstd::u64 now) noexcept -> void;
+
+        public:
+
+        ResidenceTracker() noexcept;
+
+        ResidenceTracker(const ResidenceTracker&) = delete;
+
+        auto operator =(const ResidenceTracker&) -> ResidenceTracker& = delete;
+
+        /**
+         * @param enqueue_times The timestamps the queue stamped the given tasks with.
+         */
+        auto record(std::string_view device, std::span<const dto::Task> tasks, std::span<const kstd::u64> enqueue_times) noexcept -> void;
+
+        /**
+         * @return The slowest tasks handed out recently, slowest first.
+         */
+        [[nodiscard]] auto get_slow_tasks() noexcept -> std::vector<SlowTask>;
+
+        [[nodiscard]] inline auto get_residence_times() const noexcept -> const Histogram& {
+            return _residence_times;
+        }
+    };
+}
\ No newline at end of file
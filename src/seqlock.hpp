@@ -0,0 +1,111 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Sequence lock for small trivially copyable values which are read far more often than they are written.
+     * Readers never block or write shared memory, they simply retry if a writer got in between.
+     * The value is kept in atomic words, so a torn read is discarded instead of being a data race.
+     */
+    template<typename T> requires(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>)
+    class SeqLock final {
+        static constexpr kstd::usize word_count = (sizeof(T) + sizeof(kstd::u64) - 1) / sizeof(kstd::u64);
+
+        using Words = std::array<kstd::u64, word_count>;
+
+        alignas(64) std::atomic<kstd::u64> _sequence;
+        std::array<std::atomic<kstd::u64>, word_count> _words;
+
+        inline auto store_words(const T& value) noexcept -> void {
+            Words words{};
+            std::memcpy(words.data(), &value, sizeof(T));
+
+            for (kstd::usize i = 0; i < word_count; ++i) {
+                _words[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        public:
+
+        explicit SeqLock(const T& value = {}) noexcept:
+                _sequence(0) {
+            store_words(value);
+        }
+
+        SeqLock(const SeqLock&) = delete;
+
+        auto operator =(const SeqLock&) -> SeqLock& = delete;
+
+        [[nodiscard]] inline auto load() const noexcept -> T {
+            Words words{};
+            kstd::u64 sequence = 0;
+
+            do {
+                sequence = _sequence.load(std::memory_order_acquire);
+
+                while ((sequence & 1) != 0) { // A writer is in progress
+                    sequence = _sequence.load(std::memory_order_acquire);
+                }
+
+                for (kstd::usize i = 0; i < word_count; ++i) {
+                    words[i] = _words[i].load(std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            while (_sequence.load(std::memory_order_relaxed) != sequence);
+
+            T value{};
+            std::memcpy(&value, words.data(), sizeof(T));
+            return value;
+        }
+
+        /**
+         * Applies the given function to the current value and publishes the result, writers are serialized.
+         */
+        template<typename F>
+        inline auto update(F&& function) noexcept -> T {
+            auto sequence = _sequence.load(std::memory_order_relaxed);
+
+            do {
+                while ((sequence & 1) != 0) {
+                    sequence = _sequence.load(std::memory_order_relaxed);
+                }
+            }
+            while (!_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // We own the odd sequence, so nobody else can be writing the words right now
+            Words words{};
+
+            for (kstd::usize i = 0; i < word_count; ++i) {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+
+            T value{};
+            std::memcpy(&value, words.data(), sizeof(T));
+            function(value);
+            store_words(value);
+
+            _sequence.store(sequence + 2, std::memory_order_release);
+            return value;
+        }
+
+        inline auto store(const T& value) noexcept -> void {
+            update([&value](T& current) {
+                current = value;
+            });
+        }
+    };
+}
\ No newline at end of file
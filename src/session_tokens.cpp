@@ -0,0 +1,105 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <cstring>
+#include "session_tokens.hpp"
+
+namespace fox {
+    namespace {
+        constexpr std::string_view hex_digits = "0123456789abcdef";
+
+        auto get_timestamp() noexcept -> kstd::u64 {
+            return static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+
+        auto decode_hex_digit(char digit) noexcept -> kstd::i32 {
+            if (digit >= '0' && digit <= '9') {
+                return digit - '0';
+            }
+
+            if (digit >= 'a' && digit <= 'f') {
+                return digit - 'a' + 10;
+            }
+
+            return -1;
+        }
+
+        auto write_u64(char* data, kstd::u64 value) noexcept -> void {
+            for (kstd::usize i = 0; i < 8; ++i) {
+                data[i] = static_cast<char>(value >> (56 - i * 8));
+            }
+        }
+
+        auto read_u64(const char* data) noexcept -> kstd::u64 {
+            kstd::u64 value = 0;
+
+            for (kstd::usize i = 0; i < 8; ++i) {
+                value = (value << 8) | static_cast<kstd::u8>(data[i]);
+            }
+
+            return value;
+        }
+    }
+
+    SessionTokens::SessionTokens(std::chrono::milliseconds lifetime) noexcept:
+            _key(crypto::generate_key()),
+            _nonce(0),
+            _lifetime(lifetime) {
+    }
+
+    auto SessionTokens::issue() noexcept -> std::string {
+        std::array<char, header_size> header{};
+        write_u64(header.data(), get_timestamp() + static_cast<kstd::u64>(_lifetime.count()));
+        write_u64(header.data() + 8, _nonce.fetch_add(1, std::memory_order_relaxed));
+
+        const auto mac = crypto::hmac_sha256(_key.load(), {header.data(), header.size()});
+        std::string token;
+        token.reserve(token_size);
+
+        for (const auto byte: header) {
+            token.push_back(hex_digits[(static_cast<kstd::u8>(byte) >> 4) & 0xF]);
+            token.push_back(hex_digits[static_cast<kstd::u8>(byte) & 0xF]);
+        }
+
+        for (const auto byte: mac) {
+            token.push_back(hex_digits[byte >> 4]);
+            token.push_back(hex_digits[byte & 0xF]);
+        }
+
+        return token;
+    }
+
+    auto SessionTokens::verify(std::string_view token) const noexcept -> bool {
+        if (token.size() != token_size) {
+            return false;
+        }
+
+        std::array<char, token_size / 2> bytes{};
+
+        for (kstd::usize i = 0; i < bytes.size(); ++i) {
+            const auto high = decode_hex_digit(token[i * 2]);
+            const auto low = decode_hex_digit(token[i * 2 + 1]);
+
+            if (high < 0 || low < 0) {
+                return false;
+            }
+
+            bytes[i] = static_cast<char>((high << 4) | low);
+        }
+
+        if (read_u64(bytes.data()) <= get_timestamp()) {
+            return false; // Expired
+        }
+
+        crypto::Digest mac{};
+        std::memcpy(mac.data(), bytes.data() + header_size, mac.size());
+        return crypto::constant_time_equals(crypto::hmac_sha256(_key.load(), {bytes.data(), header_size}), mac);
+    }
+
+    auto SessionTokens::rotate() noexcept -> void {
+        _key.store(crypto::generate_key());
+    }
+}
\ No newline at end of file
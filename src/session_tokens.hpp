@@ -0,0 +1,45 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <kstd/types.hpp>
+
+#include "crypto.hpp"
+#include "seqlock.hpp"
+
+namespace fox {
+    /**
+     * Issues and verifies stateless bearer tokens for the current session.
+     * A token is the hex encoding of [expiry: u64][nonce: u64][HMAC-SHA256 of the former].
+     * Rotating the key invalidates every token issued so far.
+     */
+    class SessionTokens final {
+        static constexpr kstd::usize header_size = 16;
+        static constexpr kstd::usize token_size = (header_size + sizeof(crypto::Digest)) * 2;
+
+        SeqLock<crypto::Digest> _key;
+        std::atomic<kstd::u64> _nonce;
+        std::chrono::milliseconds _lifetime;
+
+        public:
+
+        explicit SessionTokens(std::chrono::milliseconds lifetime) noexcept;
+
+        [[nodiscard]] auto issue() noexcept -> std::string;
+
+        [[nodiscard]] auto verify(std::string_view token) const noexcept -> bool;
+
+        auto rotate() noexcept -> void;
+
+        [[nodiscard]] inline auto get_lifetime() const noexcept -> std::chrono::milliseconds {
+            return _lifetime;
+        }
+    };
+}
\ No newline at end of file
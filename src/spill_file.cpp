@@ -0,0 +1,73 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include "spill_file.hpp"
+
+namespace fox {
+    SpillFile::SpillFile() noexcept:
+            _buffer_offset(0),
+            _written_count(0),
+            _read_count(0) {
+    }
+
+    auto SpillFile::open(std::filesystem::path path) noexcept -> bool {
+        _path = std::move(path);
+        return reset();
+    }
+
+    auto SpillFile::reset() noexcept -> bool {
+        _writer.close();
+        _reader.close();
+        _buffer.clear();
+        _buffer_offset = 0;
+        _written_count = 0;
+        _read_count = 0;
+
+        _writer.open(_path, std::ios::binary | std::ios::trunc);
+        _reader.open(_path, std::ios::binary);
+        return _writer.is_open() && _reader.is_open();
+    }
+
+    auto SpillFile::push(const Record& record) noexcept -> bool {
+        if (!_writer.write(reinterpret_cast<const char*>(record.data()), record_size)) {
+            _writer.clear();
+            return false;
+        }
+
+        ++_written_count;
+        return true;
+    }
+
+    auto SpillFile::pop(Record& record) noexcept -> bool {
+        if (_buffer_offset == _buffer.size()) {
+            const auto count = static_cast<kstd::usize>(std::min<kstd::u64>(_written_count - _read_count, readahead_count));
+
+            if (count == 0) {
+                return false;
+            }
+
+            // The reader only ever sees what left the write buffer
+            if (!_writer.flush()) {
+                _writer.clear();
+                return false;
+            }
+
+            _reader.clear();
+            _buffer.resize(count);
+            _buffer_offset = 0;
+
+            if (!_reader.read(reinterpret_cast<char*>(_buffer.data()), static_cast<std::streamsize>(count * record_size))) {
+                _buffer.clear();
+                return false;
+            }
+
+            _read_count += count;
+        }
+
+        record = _buffer[_buffer_offset++];
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * On-disk FIFO of fixed size records. Records are appended through a buffered writer
+     * and read back front to back in large chunks, so both directions stay sequential.
+     * Not thread-safe, the owner has to serialize access.
+     */
+    class SpillFile final {
+        public:
+
+        static constexpr kstd::usize record_size = 24;
+        static constexpr kstd::usize readahead_count = 4096; // Records read from the disk at once
+
+        using Record = std::array<kstd::u8, record_size>;
+
+        private:
+
+        std::filesystem::path _path;
+        std::ofstream _writer;
+        std::ifstream _reader;
+        std::vector<Record> _buffer;
+        kstd::usize _buffer_offset;
+        kstd::u64 _written_count;
+        kstd::u64 _read_count; // Including the records still in the buffer
+
+        public:
+
+        SpillFile() noexcept;
+
+        SpillFile(const SpillFile&) = delete;
+
+        auto operator =(const SpillFile&) -> SpillFile& = delete;
+
+        /**
+         * Opens the given file, discarding whatever a previous run left in it.
+         */
+        [[nodiscard]] auto open(std::filesystem::path path) noexcept -> bool;
+
+        [[nodiscard]] auto push(const Record& record) noexcept -> bool;
+
+        [[nodiscard]] auto pop(Record& record) noexcept -> bool;
+
+        /**
+         * Drops all records and gives the disk space back.
+         */
+        auto reset() noexcept -> bool;
+
+        [[nodiscard]] inline auto size() const noexcept -> kstd::u64 {
+            return _written_count - _read_count + (_buffer.size() - _buffer_offset);
+        }
+    };
+}
\ No newline at end of file
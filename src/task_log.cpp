@@ -0,0 +1,354 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <spdlog/spdlog.h>
+#include "task_log.hpp"
+
+namespace fox {
+    namespace {
+        constexpr std::string_view segment_extension = ".wal";
+        constexpr kstd::usize checksum_offset = TaskLog::record_size - 2;
+
+        auto store_le(kstd::u8* data, kstd::u64 value, kstd::usize size) noexcept -> void {
+            for (kstd::usize i = 0; i < size; ++i) {
+                data[i] = static_cast<kstd::u8>(value >> (i * 8));
+            }
+        }
+
+        auto load_le(const kstd::u8* data, kstd::usize size) noexcept -> kstd::u64 {
+            kstd::u64 value = 0;
+
+            for (kstd::usize i = 0; i < size; ++i) {
+                value |= static_cast<kstd::u64>(data[i]) << (i * 8);
+            }
+
+            return value;
+        }
+
+        // FNV-1a folded to 16 bits, enough to tell a torn tail from a complete record
+        auto get_checksum(const kstd::u8* data) noexcept -> kstd::u16 {
+            kstd::u32 hash = 0x811C9DC5;
+
+            for (kstd::usize i = 0; i < checksum_offset; ++i) {
+                hash = (hash ^ data[i]) * 0x01000193;
+            }
+
+            return static_cast<kstd::u16>(hash ^ (hash >> 16));
+        }
+
+        auto get_segment_path(const std::filesystem::path& directory, kstd::u64 first_sequence) noexcept -> std::filesystem::path {
+            return directory / fmt::format("{:020}{}", first_sequence, segment_extension);
+        }
+    }
+
+    TaskLogSyncer::TaskLogSyncer() noexcept:
+            _has_work(false),
+            _is_running(true),
+            _thread([this] {
+                run();
+            }) {
+    }
+
+    TaskLogSyncer::~TaskLogSyncer() noexcept {
+        stop();
+    }
+
+    auto TaskLogSyncer::add(TaskLog& log) noexcept -> void {
+        std::lock_guard lock(_mutex);
+        _logs.push_back(&log);
+    }
+
+    auto TaskLogSyncer::stop() noexcept -> void {
+        _mutex.lock();
+        _is_running = false;
+        _mutex.unlock();
+        _signal.notify_one();
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    auto TaskLogSyncer::run() noexcept -> void {
+        std::vector<TaskLog*> logs;
+
+        while (true) {
+            std::unique_lock lock(_mutex);
+            _signal.wait(lock, [this] {
+                return _has_work.load(std::memory_order_relaxed) || !_is_running;
+            });
+
+            // Whatever gets written from here on is up for the next round
+            _has_work.exchange(false, std::memory_order_acq_rel);
+            logs = _logs;
+            const auto is_running = _is_running.load();
+            lock.unlock();
+
+            for (auto* log: logs) {
+                log->sync();
+            }
+
+            if (!is_running) {
+                return;
+            }
+        }
+    }
+
+    TaskLog::TaskLog(std::filesystem::path directory, TaskLogSyncer& syncer) noexcept:
+            _directory(std::move(directory)),
+            _syncer(syncer),
+            _next_sequence(1),
+            _written_sequence(0),
+            _synced_sequence(0),
+            _has_consumed(false),
+            _has_failed(false) {
+    }
+
+    auto TaskLog::get_offset(kstd::usize lane) const noexcept -> std::atomic_ref<kstd::u64> {
+        return std::atomic_ref(reinterpret_cast<kstd::u64*>(_offsets.get_data())[lane]);
+    }
+
+    auto TaskLog::open_segment(kstd::u64 first_sequence) noexcept -> std::shared_ptr<Segment> {
+        auto segment = std::make_shared<Segment>();
+        segment->first_sequence = first_sequence;
+        segment->record_count = 0;
+        segment->last_sequences = {};
+        segment->path = get_segment_path(_directory, first_sequence);
+
+        if (!segment->file.open(segment->path, segment_size)) {
+            spdlog::error("Could not map task log segment {}", segment->path.string());
+            return nullptr;
+        }
+
+        return segment;
+    }
+
+    auto TaskLog::open(const RecordHandler& on_record) noexcept -> bool {
+        std::error_code error;
+        std::filesystem::create_directories(_directory, error);
+
+        if (error || !_offsets.open(_directory / "offsets", QueueConfig::lane_count * sizeof(kstd::u64))) {
+            return false;
+        }
+
+        std::vector<kstd::u64> first_sequences;
+
+        for (const auto& entry: std::filesystem::directory_iterator(_directory, error)) {
+            const auto name = entry.path().filename().string();
+
+            if (!name.ends_with(segment_extension)) {
+                continue;
+            }
+
+            kstd::u64 first_sequence = 0;
+            const auto* end = name.data() + name.size() - segment_extension.size();
+
+            if (std::from_chars(name.data(), end, first_sequence).ptr == end && first_sequence > 0) {
+                first_sequences.push_back(first_sequence);
+            }
+        }
+
+        if (error) {
+            return false;
+        }
+
+        std::ranges::sort(first_sequences);
+
+        // Records may have been consumed before they made it to the disk, never hand out their numbers again
+        for (kstd::usize lane = 0; lane < QueueConfig::lane_count; ++lane) {
+            _next_sequence = std::max(_next_sequence, get_offset(lane).load() + 1);
+        }
+
+        for (const auto first_sequence: first_sequences) {
+            auto segment = open_segment(first_sequence);
+
+            if (segment == nullptr) {
+                return false;
+            }
+
+            const auto* data = segment->file.get_data();
+
+            for (; segment->record_count < records_per_segment; ++segment->record_count) {
+                const auto* record = data + segment->record_count * record_size;
+                const auto sequence = load_le(record, 8);
+                const auto lane = record[8];
+                dto::Task task{};
+
+                // Stops at the first torn or unwritten record
+                if (sequence != first_sequence + segment->record_count || lane >= QueueConfig::lane_count
+                    || load_le(record + checksum_offset, 2) != get_checksum(record)
+                    || !task.set_value(static_cast<dto::TaskType>(record[9]), static_cast<kstd::u32>(load_le(record + 10, 4)))) {
+                    break;
+                }
+
+                segment->last_sequences[lane] = sequence;
+
+                if (sequence > get_offset(lane).load()) {
+                    on_record(lane, sequence, task);
+                }
+            }
+
+            // Leftovers of writes which never got synced must not pass as records later on
+            if (segment->record_count < records_per_segment) {
+                const auto offset = segment->record_count * record_size;
+                std::memset(segment->file.get_data() + offset, 0, segment_size - offset);
+
+                if (!segment->file.sync()) {
+                    return false;
+                }
+            }
+
+            _next_sequence = std::max(_next_sequence, first_sequence + segment->record_count);
+            _segments.push_back(std::move(segment));
+        }
+
+        _written_sequence = _next_sequence - 1;
+        _synced_sequence = _next_sequence - 1;
+        trim();
+        return true;
+    }
+
+    auto TaskLog::get_segment(kstd::u64 sequence) noexcept -> Segment* {
+        if (!_segments.empty()) {
+            auto& segment = *_segments.back();
+
+            // Records within a segment are contiguous, a gap left by recovery starts a new one
+            if (segment.record_count < records_per_segment && segment.first_sequence + segment.record_count == sequence) {
+                return &segment;
+            }
+        }
+
+        auto segment = open_segment(sequence);
+
+        if (segment == nullptr) {
+            return nullptr;
+        }
+
+        _segments.push_back(std::move(segment));
+        return _segments.back().get();
+    }
+
+    auto TaskLog::write_record(Segment& segment, kstd::u8 lane, kstd::u64 sequence, const dto::Task& task) noexcept -> void {
+        auto* record = segment.file.get_data() + segment.record_count * record_size;
+        store_le(record, sequence, 8);
+        record[8] = lane;
+        record[9] = static_cast<kstd::u8>(task.type);
+        store_le(record + 10, task.get_value(), 4);
+        store_le(record + checksum_offset, get_checksum(record), 2);
+
+        segment.last_sequences[lane] = sequence;
+        ++segment.record_count;
+    }
+
+    auto TaskLog::sync() noexcept -> void {
+        const auto target = _written_sequence.load(std::memory_order_acquire);
+        const auto synced = _synced_sequence.load(std::memory_order_relaxed);
+
+        if (target > synced) {
+            std::vector<std::shared_ptr<Segment>> segments;
+
+            _append_mutex.lock();
+
+            for (const auto& segment: _segments) {
+                if (segment->first_sequence + segment->record_count > synced + 1 && segment->first_sequence <= target) {
+                    segments.push_back(segment);
+                }
+            }
+
+            _append_mutex.unlock();
+
+            for (const auto& segment: segments) {
+                if (!segment->file.sync()) {
+                    spdlog::error("Could not flush task log segment {}", segment->path.string());
+                    _has_failed = true;
+                }
+            }
+
+            _sync_mutex.lock();
+            _synced_sequence.store(target, std::memory_order_release);
+            _sync_mutex.unlock();
+            _sync_signal.notify_all();
+        }
+        else if (!_syncer.is_running()) {
+            // Nothing left to flush, but waiters still have to learn about the shutdown
+            _sync_mutex.lock();
+            _sync_mutex.unlock();
+            _sync_signal.notify_all();
+        }
+
+        if (_has_consumed.exchange(false)) {
+            if (!_offsets.sync()) {
+                spdlog::warn("Could not flush task log offsets in {}", _directory.string());
+            }
+
+            trim();
+        }
+    }
+
+    auto TaskLog::wait_synced(kstd::u64 sequence) noexcept -> bool {
+        if (_synced_sequence.load(std::memory_order_acquire) >= sequence) {
+            return !_has_failed;
+        }
+
+        std::unique_lock lock(_sync_mutex);
+        _sync_signal.wait(lock, [this, sequence] {
+            return _synced_sequence.load(std::memory_order_acquire) >= sequence || !_syncer.is_running();
+        });
+
+        return _synced_sequence.load(std::memory_order_acquire) >= sequence && !_has_failed;
+    }
+
+    auto TaskLog::consume(kstd::usize lane, kstd::u64 sequence) noexcept -> void {
+        auto offset = get_offset(lane);
+        auto current = offset.load(std::memory_order_relaxed);
+
+        do {
+            if (current >= sequence) {
+                return;
+            }
+        }
+        while (!offset.compare_exchange_weak(current, sequence, std::memory_order_relaxed));
+
+        _has_consumed = true;
+        _syncer.wake();
+    }
+
+    auto TaskLog::trim() noexcept -> void {
+        std::vector<std::shared_ptr<Segment>> segments;
+
+        _append_mutex.lock();
+
+        // The newest segment stays, appends go there
+        while (_segments.size() > 1) {
+            const auto& segment = *_segments.front();
+            bool is_consumed = true;
+
+            for (kstd::usize lane = 0; lane < QueueConfig::lane_count; ++lane) {
+                is_consumed = is_consumed && get_offset(lane).load(std::memory_order_relaxed) >= segment.last_sequences[lane];
+            }
+
+            if (!is_consumed) {
+                break;
+            }
+
+            segments.push_back(std::move(_segments.front()));
+            _segments.pop_front();
+        }
+
+        _append_mutex.unlock();
+
+        for (auto& segment: segments) {
+            const auto path = segment->path;
+            segment.reset(); // Unmap before deleting
+
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <kstd/types.hpp>
+
+#include "dto.hpp"
+#include "mapped_file.hpp"
+#include "task_queue.hpp"
+
+namespace fox {
+    class TaskLog;
+
+    /**
+     * Group commit for task logs. Appending only wakes this thread, which then
+     * flushes everything written in the meantime with one sync per log,
+     * so concurrent enqueues share a single disk flush instead of queueing up for their own.
+     * Logs have to outlive the syncer.
+     */
+    class TaskLogSyncer final {
+        std::mutex _mutex;
+        std::condition_variable _signal;
+        std::vector<TaskLog*> _logs;
+        std::atomic_bool _has_work;
+        std::atomic_bool _is_running;
+        std::thread _thread;
+
+        auto run() noexcept -> void;
+
+        public:
+
+        TaskLogSyncer() noexcept;
+
+        ~TaskLogSyncer() noexcept;
+
+        TaskLogSyncer(const TaskLogSyncer&) = delete;
+
+        auto operator =(const TaskLogSyncer&) -> TaskLogSyncer& = delete;
+
+        auto add(TaskLog& log) noexcept -> void;
+
+        /**
+         * Flushes every log one last time and releases everyone waiting on a flush.
+         */
+        auto stop() noexcept -> void;
+
+        inline auto wake() noexcept -> void {
+            if (_has_work.exchange(true, std::memory_order_acq_rel)) {
+                return; // The next round picks us up anyway
+            }
+
+            _mutex.lock();
+            _mutex.unlock();
+            _signal.notify_one();
+        }
+
+        [[nodiscard]] inline auto is_running() const noexcept -> bool {
+            return _is_running.load(std::memory_order_acquire);
+        }
+    };
+
+    /**
+     * Write-ahead log of the tasks queued for a single device, split into memory-mapped segments.
+     * Every record is [sequence: u64][lane: u8][type: u8][value: u32][checksum: u16], numbered
+     * across all lanes, while each lane persists the highest sequence it handed out as its consumer offset.
+     * Records are appended under the same lock which pushes them into the queue, so every lane
+     * dequeues in log order and everything past its offset is still pending.
+     * Consumer offsets are flushed lazily, so a crash redelivers rather than loses tasks.
+     * The same goes for conflated types, whose marker only carries the sequence of the oldest pending update.
+     */
+    class TaskLog final {
+        public:
+
+        static constexpr kstd::usize record_size = 16;
+        static constexpr kstd::usize records_per_segment = 4096;
+        static constexpr kstd::usize segment_size = record_size * records_per_segment;
+
+        using RecordHandler = std::function<void(kstd::u8 lane, kstd::u64 sequence, const dto::Task& task)>;
+
+        private:
+
+        struct Segment final {
+            kstd::u64 first_sequence;
+            kstd::usize record_count;
+            std::array<kstd::u64, QueueConfig::lane_count> last_sequences; // Indexed by lane, 0 if there is none
+            std::filesystem::path path;
+            MappedFile file;
+        };
+
+        std::filesystem::path _directory;
+        TaskLogSyncer& _syncer;
+        MappedFile _offsets; // [consumed sequence: u64] per lane
+
+        std::mutex _append_mutex;
+        std::deque<std::shared_ptr<Segment>> _segments;
+        kstd::u64 _next_sequence;
+
+        std::atomic<kstd::u64> _written_sequence;
+        std::atomic<kstd::u64> _synced_sequence;
+        std::atomic_bool _has_consumed;
+        std::atomic_bool _has_failed;
+        std::mutex _sync_mutex;
+        std::condition_variable _sync_signal;
+
+        [[nodiscard]] auto get_offset(kstd::usize lane) const noexcept -> std::atomic_ref<kstd::u64>;
+
+        [[nodiscard]] auto open_segment(kstd::u64 first_sequence) noexcept -> std::shared_ptr<Segment>;
+
+        /**
+         * @return The segment the given sequence belongs into, rotating to a new one if needed.
+         */
+        [[nodiscard]] auto get_segment(kstd::u64 sequence) noexcept -> Segment*;
+
+        auto write_record(Segment& segment, kstd::u8 lane, kstd::u64 sequence, const dto::Task& task) noexcept -> void;
+
+        /**
+         * Deletes the oldest segments once every lane consumed all of their records.
+         */
+        auto trim() noexcept -> void;
+
+        public:
+
+        TaskLog(std::filesystem::path directory, TaskLogSyncer& syncer) noexcept;
+
+        TaskLog(const TaskLog&) = delete;
+
+        auto operator =(const TaskLog&) -> TaskLog& = delete;
+
+        /**
+         * Opens or creates the log and replays every record no lane has consumed yet, oldest first.
+         */
+        [[nodiscard]] auto open(const RecordHandler& on_record) noexcept -> bool;
+
+        /**
+         * Flushes everything written up to now, called by the syncer.
+         */
+        auto sync() noexcept -> void;
+
+        /**
+         * Blocks until the given record is durable.
+         * @return False if the log failed to flush or the syncer stopped first.
+         */
+        [[nodiscard]] auto wait_synced(kstd::u64 sequence) noexcept -> bool;
+
+        /**
+         * Advances the consumer offset of the given lane, which never moves backwards.
+         */
+        auto consume(kstd::usize lane, kstd::u64 sequence) noexcept -> void;
+
+        /**
+         * Logs a task, calling push with its sequence number while still holding the lock.
+         * Nothing is logged if push returns false.
+         */
+        template<typename F>
+        inline auto append(kstd::u8 lane, const dto::Task& task, F&& push) noexcept -> bool {
+            std::unique_lock lock(_append_mutex);
+            const auto sequence = _next_sequence;
+            auto* segment = get_segment(sequence);
+
+            if (segment == nullptr || !push(sequence)) {
+                return false;
+            }
+
+            write_record(*segment, lane, sequence, task);
+            _next_sequence = sequence + 1;
+            _written_sequence.store(sequence, std::memory_order_release);
+            lock.unlock();
+
+            _syncer.wake();
+            return true;
+        }
+
+        [[nodiscard]] inline auto get_written_sequence() const noexcept -> kstd::u64 {
+            return _written_sequence.load(std::memory_order_acquire);
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <charconv>
+#include <spdlog/spdlog.h>
+#include "task_queue.hpp"
+
+namespace fox {
+    namespace {
+        constexpr std::array<std::string_view, dto::task_type_count> task_type_names = {"power", "speed", "mode"};
+
+        auto next_entry(std::string_view& list) noexcept -> std::string_view {
+            const auto separator = list.find(',');
+            const auto entry = list.substr(0, separator);
+            list = separator == std::string_view::npos ? std::string_view() : list.substr(separator + 1);
+            return entry;
+        }
+
+        auto parse_number(std::string_view value, kstd::u32& out) noexcept -> bool {
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), out);
+            return error == std::errc() && end == value.data() + value.size();
+        }
+
+        auto store_le(kstd::u8* data, kstd::u64 value, kstd::usize size) noexcept -> void {
+            for (kstd::usize i = 0; i < size; ++i) {
+                data[i] = static_cast<kstd::u8>(value >> (i * 8));
+            }
+        }
+
+        auto load_le(const kstd::u8* data, kstd::usize size) noexcept -> kstd::u64 {
+            kstd::u64 value = 0;
+
+            for (kstd::usize i = 0; i < size; ++i) {
+                value |= static_cast<kstd::u64>(data[i]) << (i * 8);
+            }
+
+            return value;
+        }
+    }
+
+    auto QueueConfig::parse(std::string_view priorities, std::string_view weights, std::string_view conflated) noexcept -> std::optional<QueueConfig> {
+        QueueConfig config{};
+
+        while (!priorities.empty()) {
+            const auto entry = next_entry(priorities);
+            const auto separator = entry.find('=');
+
+            if (separator == std::string_view::npos) {
+                return std::nullopt;
+            }
+
+            const auto name = entry.substr(0, separator);
+            const auto type = std::find(task_type_names.begin(), task_type_names.end(), name);
+            kstd::u32 priority = 0;
+
+            if (type == task_type_names.end() || !parse_number(entry.substr(separator + 1), priority) || priority >= lane_count) {
+                return std::nullopt;
+            }
+
+            config.priorities[type - task_type_names.begin()] = static_cast<kstd::u8>(priority);
+        }
+
+        for (kstd::usize lane = 0; !weights.empty(); ++lane) {
+            kstd::u32 weight = 0;
+
+            if (lane >= lane_count || !parse_number(next_entry(weights), weight) || weight == 0) {
+                return std::nullopt;
+            }
+
+            config.weights[lane] = weight;
+        }
+
+        while (!conflated.empty()) {
+            const auto type = std::find(task_type_names.begin(), task_type_names.end(), next_entry(conflated));
+
+            if (type == task_type_names.end()) {
+                return std::nullopt;
+            }
+
+            config.conflated[type - task_type_names.begin()] = true;
+        }
+
+        return config;
+    }
+
+    auto QueueConfig::get_lane_capacity(kstd::usize lane, kstd::usize backlog) const noexcept -> kstd::usize {
+        std::array<bool, lane_count> is_used{};
+
+        for (const auto priority: priorities) {
+            is_used[priority] = true;
+        }
+
+        if (!is_used[lane]) {
+            return 0;
+        }
+
+        kstd::usize total_weight = 0;
+
+        for (kstd::usize i = 0; i < lane_count; ++i) {
+            total_weight += is_used[i] ? weights[i] : 0;
+        }
+
+        return std::max<kstd::usize>(backlog * weights[lane] / total_weight, 1);
+    }
+
+    TaskQueue::TaskQueue(kstd::usize capacity, const QueueConfig& config, const std::filesystem::path& spill_directory) noexcept:
+            _slots(),
+            _priorities(config.priorities),
+            _conflated(config.conflated),
+            _capacity(0) {
+        std::error_code error;
+        auto can_spill = !spill_directory.empty();
+
+        if (can_spill && !std::filesystem::create_directories(spill_directory, error) && error) {
+            spdlog::error("Could not create spill directory {}, full lanes will reject tasks", spill_directory.string());
+            can_spill = false;
+        }
+
+        for (kstd::usize i = 0; i < _lanes.size(); ++i) {
+            const auto lane_capacity = config.get_lane_capacity(i, capacity);
+            _lanes[i] = std::make_unique<Lane>(lane_capacity);
+            _capacity += lane_capacity;
+
+            if (!can_spill || lane_capacity == 0) {
+                continue;
+            }
+
+            auto spill = std::make_unique<SpillFile>();
+
+            if (!spill->open(spill_directory / fmt::format("lane-{}.spill", i))) {
+                spdlog::error("Could not open spill file for lane {} in {}", i, spill_directory.string());
+                continue;
+            }
+
+            _lanes[i]->spill = std::move(spill);
+        }
+    }
+
+    // [type: u8][is_marker: u8][unused: u16][value: u32][sequence: u64][enqueued_at: u64]
+    auto TaskQueue::encode_entry(const Entry& entry) noexcept -> SpillFile::Record {
+        SpillFile::Record record{};
+        record[0] = static_cast<kstd::u8>(entry.task.type);
+        record[1] = entry.is_marker ? 1 : 0;
+        store_le(record.data() + 4, entry.task.get_value(), 4);
+        store_le(record.data() + 8, entry.sequence, 8);
+        store_le(record.data() + 16, entry.enqueued_at, 8);
+        return record;
+    }
+
+    auto TaskQueue::decode_entry(const SpillFile::Record& record) noexcept -> Entry {
+        Entry entry{};
+        static_cast<void>(entry.task.set_value(static_cast<dto::TaskType>(record[0]), static_cast<kstd::u32>(load_le(record.data() + 4, 4))));
+        entry.is_marker = record[1] != 0;
+        entry.sequence = load_le(record.data() + 8, 8);
+        entry.enqueued_at = load_le(record.data() + 16, 8);
+        return entry;
+    }
+
+    auto TaskQueue::try_spill(Lane& lane, const dto::Task& task, kstd::u64 sequence) noexcept -> bool {
+        std::lock_guard lock(lane.spill_mutex);
+
+        if (lane.spilled_count.load(std::memory_order_relaxed) == 0 && try_reserve(lane)) {
+            push_reserved(lane, task, sequence);
+            return true;
+        }
+
+        // Conflated types always spill a marker, surplus ones find nothing pending and are skipped
+        const auto type = static_cast<kstd::usize>(task.type);
+
+        if (!lane.spill->push(encode_entry(Entry{task, _conflated[type], sequence, get_timestamp()}))) {
+            return false;
+        }
+
+        if (_conflated[type]) {
+            _slots[type].value.store(pending_bit | task.get_value(), std::memory_order_release);
+        }
+
+        lane.spilled_count.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    auto TaskQueue::refill(Lane& lane) noexcept -> void {
+        std::lock_guard lock(lane.spill_mutex);
+        SpillFile::Record record{};
+
+        while (lane.spilled_count.load(std::memory_order_relaxed) > 0 && try_reserve(lane)) {
+            if (!lane.spill->pop(record)) {
+                lane.size.fetch_sub(1, std::memory_order_release);
+                spdlog::error("Could not read back {} spilled tasks, dropping them", lane.spilled_count.load());
+                lane.spilled_count.store(0, std::memory_order_release);
+
+                // Their markers are gone, so pending values would never be delivered otherwise
+                for (kstd::usize type = 0; type < _slots.size(); ++type) {
+                    if (_conflated[type] && &lane == _lanes[_priorities[type]].get()) {
+                        _slots[type].value.fetch_and(~pending_bit, std::memory_order_acq_rel);
+                    }
+                }
+
+                break;
+            }
+
+            lane.ring.try_push(decode_entry(record));
+            lane.spilled_count.fetch_sub(1, std::memory_order_release);
+        }
+
+        if (lane.spilled_count.load(std::memory_order_relaxed) == 0 && !lane.spill->reset()) {
+            spdlog::error("Could not truncate spill file");
+        }
+    }
+}
\ No newline at end of file
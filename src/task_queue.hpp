@@ -0,0 +1,326 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <atomic_queue/atomic_queue.h>
+#include <kstd/types.hpp>
+
+#include "dto.hpp"
+#include "spill_file.hpp"
+
+namespace fox {
+    /**
+     * Maps every task type onto a priority lane, 0 being drained first,
+     * splits the backlog between the lanes by weight and selects which task types are conflated.
+     */
+    struct QueueConfig final {
+        static constexpr kstd::usize lane_count = dto::task_type_count;
+
+        std::array<kstd::u8, dto::task_type_count> priorities{0, 1, 0}; // Indexed by TaskType
+        std::array<kstd::u32, lane_count> weights{1, 1, 1}; // Indexed by priority
+        std::array<bool, dto::task_type_count> conflated{}; // Indexed by TaskType
+
+        /**
+         * Parses priorities like "power=0,speed=1,mode=0", weights like "3,1,1" and conflated types like "speed,mode".
+         */
+        [[nodiscard]] static auto parse(std::string_view priorities, std::string_view weights, std::string_view conflated) noexcept -> std::optional<QueueConfig>;
+
+        /**
+         * @return The share of the given backlog which the given lane may hold, 0 for lanes no task type maps to.
+         */
+        [[nodiscard]] auto get_lane_capacity(kstd::usize lane, kstd::usize backlog) const noexcept -> kstd::usize;
+    };
+
+    /**
+     * Bounded lock-free MPMC task queue with one lane per priority level.
+     * Every lane has its own share of the backlog, so a flood of low priority tasks
+     * can neither delay nor crowd out the ones above it.
+     * The underlying rings round their size up to the next power of two,
+     * so the actual lane limits are enforced through separate slot counters.
+     *
+     * Conflated task types don't queue every value. Their latest value lives in a per-type slot
+     * and the ring only holds a single marker for it, which keeps the position of the oldest
+     * pending update. Overwriting a pending value is a single atomic exchange.
+     *
+     * With a spill directory, a full lane doesn't reject tasks but appends them to a file instead.
+     * From then on every push to that lane queues up behind them on disk until consumers
+     * have moved all of them back into the ring, so a lane stays FIFO across both tiers.
+     */
+    class TaskQueue final {
+        static constexpr kstd::u64 pending_bit = 1ULL << 63;
+
+        struct Entry final {
+            dto::Task task;
+            bool is_marker; // The actual value has to be taken from the conflation slot
+            kstd::u64 sequence; // Position in the task log, 0 if there is none
+            kstd::u64 enqueued_at; // See get_timestamp
+        };
+
+        struct Slot final {
+            alignas(64) std::atomic<kstd::u64> value; // [pending: 1][unused: 31][value: 32]
+        };
+
+        struct Lane final {
+            atomic_queue::AtomicQueueB2<Entry> ring;
+            kstd::usize capacity;
+            alignas(64) std::atomic_size_t size;
+            alignas(64) std::atomic<kstd::u64> consumed_sequence; // Highest log sequence popped so far
+            alignas(64) std::atomic<kstd::u64> spilled_count;
+            std::unique_ptr<SpillFile> spill; // Guarded by spill_mutex, null if spilling is disabled
+            std::mutex spill_mutex;
+
+            explicit Lane(kstd::usize capacity) noexcept:
+                    ring(static_cast<unsigned>(std::max<kstd::usize>(capacity, 1))),
+                    capacity(capacity),
+                    size(0),
+                    consumed_sequence(0),
+                    spilled_count(0) {
+            }
+        };
+
+        std::array<std::unique_ptr<Lane>, QueueConfig::lane_count> _lanes;
+        std::array<Slot, dto::task_type_count> _slots;
+        std::array<kstd::u8, dto::task_type_count> _priorities;
+        std::array<bool, dto::task_type_count> _conflated;
+        kstd::usize _capacity;
+
+        static inline auto try_reserve(Lane& lane) noexcept -> bool {
+            auto size = lane.size.load(std::memory_order_relaxed);
+
+            do { // Reserve a slot before touching the ring, so we never exceed our share
+                if (size >= lane.capacity) {
+                    return false;
+                }
+            }
+            while (!lane.size.compare_exchange_weak(size, size + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+            return true;
+        }
+
+        [[nodiscard]] static auto encode_entry(const Entry& entry) noexcept -> SpillFile::Record;
+
+        [[nodiscard]] static auto decode_entry(const SpillFile::Record& record) noexcept -> Entry;
+
+        /**
+         * Appends a task to the spill file of a lane, or pushes it into the ring if the file got drained in the meantime.
+         */
+        auto try_spill(Lane& lane, const dto::Task& task, kstd::u64 sequence) noexcept -> bool;
+
+        /**
+         * Moves spilled entries back into the ring, as far as the lane has room.
+         */
+        auto refill(Lane& lane) noexcept -> void;
+
+        inline auto push_reserved(Lane& lane, const dto::Task& task, kstd::u64 sequence) noexcept -> void {
+            const auto enqueued_at = get_timestamp();
+            const auto type = static_cast<kstd::usize>(task.type);
+
+            if (_conflated[type]) {
+                const auto previous = _slots[type].value.exchange(pending_bit | task.get_value(), std::memory_order_acq_rel);
+
+                if ((previous & pending_bit) != 0) { // Overwrote a pending value, its marker still holds our place
+                    lane.size.fetch_sub(1, std::memory_order_release);
+                    return;
+                }
+
+                lane.ring.try_push(Entry{task, true, sequence, enqueued_at});
+                return;
+            }
+
+            lane.ring.try_push(Entry{task, false, sequence, enqueued_at}); // Can't fail, we hold a reservation and the ring is at least as big as our share
+        }
+
+        inline auto try_pop_lane(Lane& lane, std::span<dto::Task> out, std::span<kstd::u64> enqueue_times) noexcept -> kstd::usize {
+            if (lane.spilled_count.load(std::memory_order_acquire) > 0) {
+                refill(lane);
+            }
+
+            kstd::usize count = 0;
+            kstd::usize popped_count = 0;
+            kstd::u64 last_sequence = 0;
+            Entry entry{};
+
+            while (count < out.size() && lane.ring.try_pop(entry)) {
+                ++popped_count;
+                last_sequence = std::max(last_sequence, entry.sequence);
+
+                if (!entry.is_marker) {
+                    if (!enqueue_times.empty()) {
+                        enqueue_times[count] = entry.enqueued_at;
+                    }
+
+                    out[count++] = entry.task;
+                    continue;
+                }
+
+                // Taking the value and clearing the pending bit at once lets the next enqueue push a new marker
+                const auto type = entry.task.type;
+                const auto value = _slots[static_cast<kstd::usize>(type)].value.fetch_and(~pending_bit, std::memory_order_acq_rel);
+
+                if ((value & pending_bit) != 0 && out[count].set_value(type, static_cast<kstd::u32>(value))) {
+                    if (!enqueue_times.empty()) {
+                        enqueue_times[count] = entry.enqueued_at; // The oldest pending update is what waited the longest
+                    }
+
+                    ++count;
+                }
+            }
+
+            if (popped_count > 0) {
+                lane.size.fetch_sub(popped_count, std::memory_order_release);
+            }
+
+            auto consumed_sequence = lane.consumed_sequence.load(std::memory_order_relaxed);
+
+            while (last_sequence > consumed_sequence && !lane.consumed_sequence.compare_exchange_weak(consumed_sequence, last_sequence, std::memory_order_relaxed)) {
+            }
+
+            return count;
+        }
+
+        public:
+
+        /**
+         * @param spill_directory Where to put the spill files of the lanes, empty to reject tasks once a lane is full.
+         */
+        TaskQueue(kstd::usize capacity, const QueueConfig& config, const std::filesystem::path& spill_directory = {}) noexcept;
+
+        TaskQueue(const TaskQueue&) = delete;
+
+        auto operator =(const TaskQueue&) -> TaskQueue& = delete;
+
+        inline auto try_push(const dto::Task& task, kstd::u64 sequence = 0) noexcept -> bool {
+            const auto lane = get_lane(task.type);
+            return lane && try_push_to_lane(task, *lane, sequence);
+        }
+
+        /**
+         * Pushes into the given lane regardless of the priority of the task,
+         * used to restore logged tasks into the lane they were logged for.
+         */
+        inline auto try_push_to_lane(const dto::Task& task, kstd::usize lane_index, kstd::u64 sequence) noexcept -> bool {
+            const auto type = static_cast<kstd::usize>(task.type);
+
+            if (type >= _priorities.size() || lane_index >= _lanes.size()) {
+                return false;
+            }
+
+            auto& lane = *_lanes[lane_index];
+
+            // Conflated values need a reservation too, in case there is no marker to piggyback on.
+            // Once anything spilled, we have to queue up behind it
+            if (lane.spilled_count.load(std::memory_order_acquire) == 0 && try_reserve(lane)) {
+                push_reserved(lane, task, sequence);
+                return true;
+            }
+
+            return lane.spill != nullptr && try_spill(lane, task, sequence);
+        }
+
+        inline auto try_pop() noexcept -> std::optional<dto::Task> {
+            dto::Task task{};
+
+            if (try_pop_batch({&task, 1}) == 0) {
+                return std::nullopt;
+            }
+
+            return {task};
+        }
+
+        /**
+         * Moves as many tasks as fit into the given span out of the queue, highest priority first,
+         * releasing the slots of each lane with a single counter update.
+         * @param enqueue_times Receives the enqueue timestamp of every task if not empty, has to be at least as big as out.
+         * @return The number of tasks written to the front of the span.
+         */
+        inline auto try_pop_batch(std::span<dto::Task> out, std::span<kstd::u64> enqueue_times = {}) noexcept -> kstd::usize {
+            kstd::usize count = 0;
+
+            for (auto& lane: _lanes) {
+                if (count == out.size()) {
+                    break;
+                }
+
+                count += try_pop_lane(*lane, out.subspan(count), enqueue_times.empty() ? enqueue_times : enqueue_times.subspan(count));
+            }
+
+            return count;
+        }
+
+        inline auto clear() noexcept -> kstd::usize {
+            kstd::usize count = 0;
+
+            while (try_pop()) {
+                ++count;
+            }
+
+            return count;
+        }
+
+        /**
+         * @return Microseconds on the monotonic clock, which is what tasks are stamped with when they are pushed.
+         */
+        [[nodiscard]] static inline auto get_timestamp() noexcept -> kstd::u64 {
+            return static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        [[nodiscard]] inline auto size() const noexcept -> kstd::usize {
+            kstd::usize size = 0;
+
+            for (const auto& lane: _lanes) {
+                size += lane->size.load(std::memory_order_relaxed) + lane->spilled_count.load(std::memory_order_relaxed);
+            }
+
+            return size;
+        }
+
+        [[nodiscard]] inline auto get_lane(dto::TaskType type) const noexcept -> std::optional<kstd::usize> {
+            const auto index = static_cast<kstd::usize>(type);
+
+            if (index >= _priorities.size()) {
+                return std::nullopt;
+            }
+
+            return _priorities[index];
+        }
+
+        [[nodiscard]] inline auto get_consumed_sequence(kstd::usize lane) const noexcept -> kstd::u64 {
+            return _lanes[lane]->consumed_sequence.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto get_lane_size(kstd::usize lane) const noexcept -> kstd::usize {
+            return _lanes[lane]->size.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto get_spilled_count() const noexcept -> kstd::usize {
+            kstd::usize count = 0;
+
+            for (const auto& lane: _lanes) {
+                count += lane->spilled_count.load(std::memory_order_relaxed);
+            }
+
+            return count;
+        }
+
+        [[nodiscard]] inline auto get_lane_capacity(kstd::usize lane) const noexcept -> kstd::usize {
+            return _lanes[lane]->capacity;
+        }
+
+        [[nodiscard]] inline auto get_capacity() const noexcept -> kstd::usize {
+            return _capacity;
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,561 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <cctype>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include "websocket.hpp"
+
+#ifdef PLATFORM_WINDOWS
+#include <ws2tcpip.h>
+#define FOX_INVALID_SOCKET INVALID_SOCKET
+#define FOX_SHUTDOWN_BOTH SD_BOTH
+#define fox_poll WSAPoll
+#define fox_close_socket closesocket
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#define FOX_INVALID_SOCKET (-1)
+#define FOX_SHUTDOWN_BOTH SHUT_RDWR
+#define fox_poll poll
+#define fox_close_socket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace fox {
+    namespace {
+        constexpr std::string_view handshake_guid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        constexpr kstd::usize max_handshake_size = 8192;
+        constexpr kstd::i32 io_timeout_ms = 5000;
+
+        enum Opcode : kstd::u8 {
+            CONTINUATION = 0x0,
+            TEXT = 0x1,
+            BINARY = 0x2,
+            CLOSE = 0x8,
+            PING = 0x9,
+            PONG = 0xA
+        };
+
+        auto wait_readable(socket_t socket, kstd::i32 timeout_ms) noexcept -> kstd::i32 {
+            pollfd fd{};
+            fd.fd = socket;
+            fd.events = POLLIN;
+            return fox_poll(&fd, 1, timeout_ms);
+        }
+
+        auto send_all(socket_t socket, const char* data, kstd::usize size) noexcept -> bool {
+            while (size > 0) {
+                const auto sent = ::send(socket, data, static_cast<kstd::i32>(size), MSG_NOSIGNAL);
+
+                if (sent <= 0) {
+                    return false;
+                }
+
+                data += sent;
+                size -= static_cast<kstd::usize>(sent);
+            }
+
+            return true;
+        }
+
+        // Only used for the opening handshake, so simplicity beats speed here
+        auto sha1(std::string_view data) noexcept -> std::array<kstd::u8, 20> {
+            constexpr auto rotl = [](kstd::u32 value, kstd::u32 bits) {
+                return (value << bits) | (value >> (32 - bits));
+            };
+
+            std::array<kstd::u32, 5> h = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+            std::string message(data);
+            const auto bit_length = static_cast<kstd::u64>(data.size()) * 8;
+            message.push_back(static_cast<char>(0x80));
+
+            while (message.size() % 64 != 56) {
+                message.push_back('\0');
+            }
+
+            for (kstd::i32 i = 7; i >= 0; --i) {
+                message.push_back(static_cast<char>((bit_length >> (i * 8)) & 0xFF));
+            }
+
+            for (kstd::usize chunk = 0; chunk < message.size(); chunk += 64) {
+                std::array<kstd::u32, 80> w{};
+
+                for (kstd::usize i = 0; i < 16; ++i) {
+                    const auto* bytes = reinterpret_cast<const kstd::u8*>(message.data() + chunk + i * 4);
+                    w[i] = (static_cast<kstd::u32>(bytes[0]) << 24) | (static_cast<kstd::u32>(bytes[1]) << 16) | (static_cast<kstd::u32>(bytes[2]) << 8) | bytes[3];
+                }
+
+                for (kstd::usize i = 16; i < 80; ++i) {
+                    w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+                }
+
+                auto [a, b, c, d, e] = h;
+
+                for (kstd::usize i = 0; i < 80; ++i) {
+                    kstd::u32 f;
+                    kstd::u32 k;
+
+                    if (i < 20) {
+                        f = (b & c) | (~b & d);
+                        k = 0x5A827999;
+                    }
+                    else if (i < 40) {
+                        f = b ^ c ^ d;
+                        k = 0x6ED9EBA1;
+                    }
+                    else if (i < 60) {
+                        f = (b & c) | (b & d) | (c & d);
+                        k = 0x8F1BBCDC;
+                    }
+                    else {
+                        f = b ^ c ^ d;
+                        k = 0xCA62C1D6;
+                    }
+
+                    const auto temp = rotl(a, 5) + f + e + k + w[i];
+                    e = d;
+                    d = c;
+                    c = rotl(b, 30);
+                    b = a;
+                    a = temp;
+                }
+
+                h[0] += a;
+                h[1] += b;
+                h[2] += c;
+                h[3] += d;
+                h[4] += e;
+            }
+
+            std::array<kstd::u8, 20> result{};
+
+            for (kstd::usize i = 0; i < 20; ++i) {
+                result[i] = static_cast<kstd::u8>(h[i / 4] >> (24 - (i % 4) * 8));
+            }
+
+            return result;
+        }
+
+        auto base64_encode(const kstd::u8* data, kstd::usize size) noexcept -> std::string {
+            constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::string result;
+            result.reserve(((size + 2) / 3) * 4);
+
+            for (kstd::usize i = 0; i < size; i += 3) {
+                const auto remaining = size - i;
+                const kstd::u32 group = (static_cast<kstd::u32>(data[i]) << 16)
+                                        | (remaining > 1 ? static_cast<kstd::u32>(data[i + 1]) << 8 : 0)
+                                        | (remaining > 2 ? static_cast<kstd::u32>(data[i + 2]) : 0);
+
+                result.push_back(alphabet[(group >> 18) & 0x3F]);
+                result.push_back(alphabet[(group >> 12) & 0x3F]);
+                result.push_back(remaining > 1 ? alphabet[(group >> 6) & 0x3F] : '=');
+                result.push_back(remaining > 2 ? alphabet[group & 0x3F] : '=');
+            }
+
+            return result;
+        }
+
+        auto find_header(std::string_view request, std::string_view name) noexcept -> std::string_view {
+            kstd::usize line_start = request.find("\r\n");
+
+            while (line_start != std::string_view::npos) {
+                line_start += 2;
+                const auto line_end = request.find("\r\n", line_start);
+
+                if (line_end == std::string_view::npos || line_end == line_start) {
+                    break;
+                }
+
+                const auto line = request.substr(line_start, line_end - line_start);
+                const auto separator = line.find(':');
+
+                if (separator == name.size() && std::equal(name.begin(), name.end(), line.begin(), [](char a, char b) {
+                    return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+                })) {
+                    auto value = line.substr(separator + 1);
+
+                    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+                        value.remove_prefix(1);
+                    }
+
+                    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+                        value.remove_suffix(1);
+                    }
+
+                    return value;
+                }
+
+                line_start = line_end;
+            }
+
+            return {};
+        }
+    }
+
+    WebSocket::WebSocket(socket_t socket) noexcept:
+            _socket(socket),
+            _is_open(true) {
+    }
+
+    auto WebSocket::read_exact(void* data, kstd::usize size) noexcept -> bool {
+        auto* bytes = static_cast<char*>(data);
+
+        while (size > 0) {
+            if (wait_readable(_socket, io_timeout_ms) <= 0) {
+                return false;
+            }
+
+            const auto received = ::recv(_socket, bytes, static_cast<kstd::i32>(size), 0);
+
+            if (received <= 0) {
+                return false;
+            }
+
+            bytes += received;
+            size -= static_cast<kstd::usize>(received);
+        }
+
+        return true;
+    }
+
+    auto WebSocket::send_frame(kstd::u8 opcode, std::string_view payload) noexcept -> bool {
+        std::array<kstd::u8, 10> header{};
+        kstd::usize header_size = 2;
+        header[0] = 0x80 | opcode; // We never fragment outgoing messages
+
+        if (payload.size() < 126) {
+            header[1] = static_cast<kstd::u8>(payload.size());
+        }
+        else if (payload.size() <= 0xFFFF) {
+            header[1] = 126;
+            header[2] = static_cast<kstd::u8>(payload.size() >> 8);
+            header[3] = static_cast<kstd::u8>(payload.size());
+            header_size = 4;
+        }
+        else {
+            header[1] = 127;
+
+            for (kstd::usize i = 0; i < 8; ++i) {
+                header[2 + i] = static_cast<kstd::u8>(static_cast<kstd::u64>(payload.size()) >> ((7 - i) * 8));
+            }
+
+            header_size = 10;
+        }
+
+        std::lock_guard lock(_send_mutex);
+
+        if (!send_all(_socket, reinterpret_cast<const char*>(header.data()), header_size) || !send_all(_socket, payload.data(), payload.size())) {
+            _is_open = false;
+            return false;
+        }
+
+        return true;
+    }
+
+    auto WebSocket::receive(std::string& message, std::chrono::milliseconds timeout) noexcept -> ReceiveStatus {
+        message.clear();
+        bool is_fragmented = false;
+
+        while (_is_open) {
+            if (!is_fragmented) {
+                const auto result = wait_readable(_socket, static_cast<kstd::i32>(timeout.count()));
+
+                if (result == 0) {
+                    return ReceiveStatus::TIMEOUT;
+                }
+
+                if (result < 0) {
+                    break;
+                }
+            }
+
+            std::array<kstd::u8, 2> header{};
+
+            if (!read_exact(header.data(), header.size())) {
+                break;
+            }
+
+            const auto is_final = (header[0] & 0x80) != 0;
+            const auto opcode = static_cast<kstd::u8>(header[0] & 0x0F);
+            const auto is_masked = (header[1] & 0x80) != 0;
+            kstd::u64 length = header[1] & 0x7F;
+
+            if (length == 126) {
+                std::array<kstd::u8, 2> extended{};
+
+                if (!read_exact(extended.data(), extended.size())) {
+                    break;
+                }
+
+                length = (static_cast<kstd::u64>(extended[0]) << 8) | extended[1];
+            }
+            else if (length == 127) {
+                std::array<kstd::u8, 8> extended{};
+
+                if (!read_exact(extended.data(), extended.size())) {
+                    break;
+                }
+
+                length = 0;
+
+                for (const auto byte: extended) {
+                    length = (length << 8) | byte;
+                }
+            }
+
+            if (!is_masked) { // Clients are required to mask everything they send
+                close(1002);
+                break;
+            }
+
+            const auto is_control = (opcode & 0x08) != 0;
+
+            if ((is_control && (length > 125 || !is_final)) || message.size() + length > max_message_size) {
+                close(is_control ? 1002 : 1009);
+                break;
+            }
+
+            std::array<kstd::u8, 4> mask{};
+
+            if (!read_exact(mask.data(), mask.size())) {
+                break;
+            }
+
+            std::string payload(static_cast<kstd::usize>(length), '\0');
+
+            if (length > 0 && !read_exact(payload.data(), payload.size())) {
+                break;
+            }
+
+            for (kstd::usize i = 0; i < payload.size(); ++i) {
+                payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+            }
+
+            switch (opcode) {
+                case Opcode::PING:
+                    send_frame(Opcode::PONG, payload);
+                    continue;
+                case Opcode::PONG:
+                    continue;
+                case Opcode::CLOSE:
+                    if (_is_open.exchange(false)) {
+                        send_frame(Opcode::CLOSE, std::string_view(payload).substr(0, 2));
+                    }
+                    return ReceiveStatus::CLOSED;
+                case Opcode::TEXT:
+                case Opcode::BINARY:
+                    if (is_fragmented) {
+                        close(1002);
+                        return ReceiveStatus::CLOSED;
+                    }
+                    break;
+                case Opcode::CONTINUATION:
+                    if (!is_fragmented) {
+                        close(1002);
+                        return ReceiveStatus::CLOSED;
+                    }
+                    break;
+                default:
+                    close(1002);
+                    return ReceiveStatus::CLOSED;
+            }
+
+            message.append(payload);
+
+            if (is_final) {
+                return ReceiveStatus::MESSAGE;
+            }
+
+            is_fragmented = true;
+        }
+
+        _is_open = false;
+        return ReceiveStatus::CLOSED;
+    }
+
+    auto WebSocket::send(std::string_view message) noexcept -> bool {
+        if (!_is_open) {
+            return false;
+        }
+
+        return send_frame(Opcode::TEXT, message);
+    }
+
+    auto WebSocket::close(kstd::u16 code) noexcept -> void {
+        if (!_is_open.exchange(false)) {
+            return;
+        }
+
+        const std::array<char, 2> payload = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+        send_frame(Opcode::CLOSE, std::string_view(payload.data(), payload.size()));
+        ::shutdown(_socket, FOX_SHUTDOWN_BOTH); // Wakes up a receiving thread
+    }
+
+    WebSocketServer::WebSocketServer(kstd::u32 max_connections, Handler handler) noexcept:
+            _handler(std::move(handler)),
+            _max_connections(max_connections),
+            _is_running(true),
+            _socket(FOX_INVALID_SOCKET) {
+    }
+
+    WebSocketServer::~WebSocketServer() noexcept {
+        stop();
+    }
+
+    auto WebSocketServer::accept_handshake(socket_t socket) noexcept -> bool {
+        std::string request;
+        std::array<char, 1024> buffer{};
+
+        while (request.find("\r\n\r\n") == std::string::npos) {
+            if (request.size() >= max_handshake_size || wait_readable(socket, io_timeout_ms) <= 0) {
+                return false;
+            }
+
+            const auto received = ::recv(socket, buffer.data(), static_cast<kstd::i32>(buffer.size()), 0);
+
+            if (received <= 0) {
+                return false;
+            }
+
+            request.append(buffer.data(), static_cast<kstd::usize>(received));
+        }
+
+        const auto key = find_header(request, "Sec-WebSocket-Key");
+
+        if (!request.starts_with("GET ") || key.empty()) {
+            constexpr std::string_view response = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            send_all(socket, response.data(), response.size());
+            return false;
+        }
+
+        const auto digest = sha1(std::string(key) + std::string(handshake_guid));
+        const auto response = "HTTP/1.1 101 Switching Protocols\r\n"
+                              "Upgrade: websocket\r\n"
+                              "Connection: Upgrade\r\n"
+                              "Sec-WebSocket-Accept: " + base64_encode(digest.data(), digest.size()) + "\r\n\r\n";
+
+        return send_all(socket, response.data(), response.size());
+    }
+
+    auto WebSocketServer::run_connection(socket_t socket) noexcept -> void {
+        constexpr kstd::i32 no_delay = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+
+        if (accept_handshake(socket)) {
+            WebSocket web_socket(socket);
+            _handler(web_socket);
+            web_socket.close();
+        }
+
+        // Erased and closed under the lock: accept may hand out the same fd as soon as it's closed,
+        // and stop may return, freeing us, as soon as the set runs empty and the lock is released
+        const std::lock_guard lock(_connections_mutex);
+        _connections.erase(socket);
+        fox_close_socket(socket);
+        _connections_signal.notify_all();
+    }
+
+    auto WebSocketServer::listen(const std::string& address, kstd::u32 port) noexcept -> bool {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* addresses = nullptr;
+
+        if (getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+            spdlog::error("Could not resolve WebSocket address {}:{}", address, port);
+            return false;
+        }
+
+        for (auto* info = addresses; info != nullptr; info = info->ai_next) {
+            const auto socket = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+
+            if (socket == FOX_INVALID_SOCKET) {
+                continue;
+            }
+
+            constexpr kstd::i32 reuse_address = 1;
+            setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse_address), sizeof(reuse_address));
+
+            if (::bind(socket, info->ai_addr, static_cast<kstd::i32>(info->ai_addrlen)) != 0 || ::listen(socket, SOMAXCONN) != 0) {
+                fox_close_socket(socket);
+                continue;
+            }
+
+            _socket = socket;
+            break;
+        }
+
+        freeaddrinfo(addresses);
+
+        if (_socket == FOX_INVALID_SOCKET) {
+            spdlog::error("Could not bind WebSocket server to {}:{}", address, port);
+            return false;
+        }
+
+        spdlog::info("WebSocket server listening on {}:{}", address, port);
+
+        while (_is_running) {
+            if (wait_readable(_socket, 250) <= 0) {
+                continue;
+            }
+
+            const auto socket = ::accept(_socket, nullptr, nullptr);
+
+            if (socket == FOX_INVALID_SOCKET) {
+                continue;
+            }
+
+#ifdef SO_NOSIGPIPE
+            constexpr kstd::i32 no_sigpipe = 1;
+            setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+            std::unique_lock lock(_connections_mutex);
+
+            if (!_is_running || _connections.size() >= _max_connections) {
+                lock.unlock();
+                spdlog::debug("Rejected WebSocket connection");
+                fox_close_socket(socket);
+                continue;
+            }
+
+            _connections.insert(socket);
+            lock.unlock();
+
+            std::thread(&WebSocketServer::run_connection, this, socket).detach();
+        }
+
+        fox_close_socket(_socket);
+        _socket = FOX_INVALID_SOCKET;
+        return true;
+    }
+
+    auto WebSocketServer::stop() noexcept -> void {
+        std::unique_lock lock(_connections_mutex);
+        _is_running = false;
+
+        for (const auto socket: _connections) {
+            ::shutdown(socket, FOX_SHUTDOWN_BOTH);
+        }
+
+        // Connection threads are detached, so we have to wait until they let go of us
+        _connections_signal.wait(lock, [this] {
+            return _connections.empty();
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <unordered_set>
+#include <kstd/types.hpp>
+
+#ifdef PLATFORM_WINDOWS
+#include <winsock2.h>
+#endif
+
+namespace fox {
+#ifdef PLATFORM_WINDOWS
+    using socket_t = SOCKET;
+#else
+    using socket_t = int;
+#endif
+
+    enum class ReceiveStatus : kstd::u8 {
+        MESSAGE,
+        TIMEOUT,
+        CLOSED
+    };
+
+    /**
+     * A single server-side RFC 6455 connection which has already completed its handshake.
+     * Receiving is meant to happen on one thread, sending is safe from any thread.
+     */
+    class WebSocket final {
+        static constexpr kstd::usize max_message_size = 1024 * 1024;
+
+        socket_t _socket;
+        std::mutex _send_mutex;
+        std::atomic_bool _is_open;
+
+        auto read_exact(void* data, kstd::usize size) noexcept -> bool;
+
+        auto send_frame(kstd::u8 opcode, std::string_view payload) noexcept -> bool;
+
+        public:
+
+        explicit WebSocket(socket_t socket) noexcept;
+
+        WebSocket(const WebSocket&) = delete;
+
+        auto operator =(const WebSocket&) -> WebSocket& = delete;
+
+        /**
+         * Waits for the next complete text or binary message, answering pings and close requests on the way.
+         */
+        [[nodiscard]] auto receive(std::string& message, std::chrono::milliseconds timeout) noexcept -> ReceiveStatus;
+
+        auto send(std::string_view message) noexcept -> bool;
+
+        auto close(kstd::u16 code = 1000) noexcept -> void;
+
+        [[nodiscard]] inline auto is_open() const noexcept -> bool {
+            return _is_open;
+        }
+    };
+
+    class WebSocketServer final {
+        using Handler = std::function<void(WebSocket&)>;
+
+        Handler _handler;
+        kstd::u32 _max_connections;
+        std::atomic_bool _is_running;
+        socket_t _socket;
+
+        std::mutex _connections_mutex;
+        std::condition_variable _connections_signal;
+        std::unordered_set<socket_t> _connections;
+
+        static auto accept_handshake(socket_t socket) noexcept -> bool;
+
+        auto run_connection(socket_t socket) noexcept -> void;
+
+        public:
+
+        WebSocketServer(kstd::u32 max_connections, Handler handler) noexcept;
+
+        ~WebSocketServer() noexcept;
+
+        /**
+         * Accepts connections until stop is called, every connection is served on its own thread.
+         */
+        auto listen(const std::string& address, kstd::u32 port) noexcept -> bool;
+
+        auto stop() noexcept -> void;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <fstream>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fmt/format.h>
+#include "task_log.hpp"
+
+namespace {
+    using Record = std::tuple<kstd::u8, kstd::u64, fox::dto::TaskType, kstd::u32>; // [lane, sequence, type, value]
+
+    auto make_task(fox::dto::TaskType type, kstd::u32 value) -> fox::dto::Task {
+        fox::dto::Task task{};
+        static_cast<void>(task.set_value(type, value));
+        return task;
+    }
+
+    class TaskLogTest : public testing::Test {
+        protected:
+
+        std::filesystem::path _directory;
+        // Logs are never added to it, so nothing gets flushed and dropping a log is as good as a crash
+        fox::TaskLogSyncer _syncer;
+
+        auto SetUp() -> void override {
+            _directory = std::filesystem::temp_directory_path() / fmt::format("fox-task-log-test-{}", std::random_device()());
+        }
+
+        auto TearDown() -> void override {
+            std::error_code error;
+            std::filesystem::remove_all(_directory, error);
+        }
+
+        auto open_log(std::vector<Record>& records) -> std::unique_ptr<fox::TaskLog> {
+            auto log = std::make_unique<fox::TaskLog>(_directory, _syncer);
+
+            const auto is_open = log->open([&records](kstd::u8 lane, kstd::u64 sequence, const fox::dto::Task& task) {
+                records.emplace_back(lane, sequence, task.type, task.get_value());
+            });
+
+            return is_open ? std::move(log) : nullptr;
+        }
+
+        static auto append(fox::TaskLog& log, kstd::u8 lane, fox::dto::TaskType type, kstd::u32 value) -> bool {
+            return log.append(lane, make_task(type, value), [](kstd::u64) {
+                return true;
+            });
+        }
+    };
+}
+
+TEST_F(TaskLogTest, ReplaysUnconsumedRecordsAfterUncleanStop) {
+    using enum fox::dto::TaskType;
+
+    {
+        std::vector<Record> records;
+        auto log = open_log(records);
+        ASSERT_NE(log, nullptr);
+        EXPECT_TRUE(records.empty());
+
+        ASSERT_TRUE(append(*log, 0, POWER, 1)); // 1
+        ASSERT_TRUE(append(*log, 1, SPEED, 10)); // 2
+        ASSERT_TRUE(append(*log, 0, MODE, 0)); // 3
+        ASSERT_TRUE(append(*log, 1, SPEED, 20)); // 4
+        ASSERT_TRUE(append(*log, 0, POWER, 0)); // 5
+        ASSERT_TRUE(append(*log, 2, MODE, 0)); // 6
+
+        // Every lane has its own offset, consuming lane 0 must not release lane 1 or the other way around
+        log->consume(0, 3);
+        log->consume(1, 2);
+        log->consume(1, 1); // Offsets never move backwards
+    }
+
+    std::vector<Record> records;
+    auto log = open_log(records);
+    ASSERT_NE(log, nullptr);
+
+    const std::vector<Record> expected = {
+        {1, 4, SPEED, 20},
+        {0, 5, POWER, 0},
+        {2, 6, MODE, 0}
+    };
+    EXPECT_EQ(records, expected);
+
+    ASSERT_TRUE(append(*log, 0, POWER, 1));
+    EXPECT_EQ(log->get_written_sequence(), 7);
+}
+
+TEST_F(TaskLogTest, NeverReusesConsumedSequences) {
+    using enum fox::dto::TaskType;
+
+    {
+        std::vector<Record> records;
+        auto log = open_log(records);
+        ASSERT_NE(log, nullptr);
+
+        ASSERT_TRUE(append(*log, 0, POWER, 1));
+        ASSERT_TRUE(append(*log, 1, SPEED, 10));
+        ASSERT_TRUE(append(*log, 1, SPEED, 20));
+        log->consume(1, 3);
+    }
+
+    // The records never made it to the disk, but their consumer offset did
+    for (const auto& entry: std::filesystem::directory_iterator(_directory)) {
+        if (entry.path().extension() == ".wal") {
+            std::filesystem::remove(entry.path());
+        }
+    }
+
+    std::vector<Record> records;
+    auto log = open_log(records);
+    ASSERT_NE(log, nullptr);
+    EXPECT_TRUE(records.empty());
+
+    ASSERT_TRUE(append(*log, 1, SPEED, 30));
+    EXPECT_EQ(log->get_written_sequence(), 4);
+}
+
+TEST_F(TaskLogTest, StopsReplayingAtTornRecord) {
+    using enum fox::dto::TaskType;
+
+    {
+        std::vector<Record> records;
+        auto log = open_log(records);
+        ASSERT_NE(log, nullptr);
+
+        ASSERT_TRUE(append(*log, 0, POWER, 1));
+        ASSERT_TRUE(append(*log, 1, SPEED, 10));
+        ASSERT_TRUE(append(*log, 1, SPEED, 20));
+    }
+
+    // Flip a bit in the value of the last record, as if the process died halfway through writing it
+    {
+        std::fstream segment(_directory / fmt::format("{:020}.wal", 1), std::ios::binary | std::ios::in | std::ios::out);
+        ASSERT_TRUE(segment.is_open());
+        segment.seekp(2 * fox::TaskLog::record_size + 10);
+        segment.put(static_cast<char>(21));
+    }
+
+    {
+        std::vector<Record> records;
+        auto log = open_log(records);
+        ASSERT_NE(log, nullptr);
+
+        const std::vector<Record> expected = {
+            {0, 1, POWER, 1},
+            {1, 2, SPEED, 10}
+        };
+        EXPECT_EQ(records, expected);
+
+        // The torn record's number is free again, and its leftovers must not resurface behind the new one
+        ASSERT_TRUE(append(*log, 1, SPEED, 30));
+        EXPECT_EQ(log->get_written_sequence(), 3);
+    }
+
+    std::vector<Record> records;
+    auto log = open_log(records);
+    ASSERT_NE(log, nullptr);
+
+    const std::vector<Record> expected = {
+        {0, 1, POWER, 1},
+        {1, 2, SPEED, 10},
+        {1, 3, SPEED, 30}
+    };
+    EXPECT_EQ(records, expected);
+}
+
+TEST_F(TaskLogTest, SkipsRejectedPushes) {
+    using enum fox::dto::TaskType;
+
+    {
+        std::vector<Record> records;
+        auto log = open_log(records);
+        ASSERT_NE(log, nullptr);
+
+        ASSERT_TRUE(append(*log, 0, POWER, 1));
+        EXPECT_FALSE(log->append(0, make_task(POWER, 0), [](kstd::u64) {
+            return false; // Like a full queue
+        }));
+        ASSERT_TRUE(append(*log, 0, MODE, 0));
+    }
+
+    std::vector<Record> records;
+    auto log = open_log(records);
+    ASSERT_NE(log, nullptr);
+
+    const std::vector<Record> expected = {
+        {0, 1, POWER, 1},
+        {0, 2, MODE, 0}
+    };
+    EXPECT_EQ(records, expected);
+}
@@ -0,0 +1,134 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <random>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fmt/format.h>
+#include "task_queue.hpp"
+
+namespace {
+    using Value = std::pair<fox::dto::TaskType, kstd::u32>;
+
+    auto make_task(fox::dto::TaskType type, kstd::u32 value) -> fox::dto::Task {
+        fox::dto::Task task{};
+        static_cast<void>(task.set_value(type, value));
+        return task;
+    }
+
+    auto drain(fox::TaskQueue& queue) -> std::vector<Value> {
+        std::vector<Value> values;
+
+        while (const auto task = queue.try_pop()) {
+            values.emplace_back(task->type, task->get_value());
+        }
+
+        return values;
+    }
+
+    class TaskQueueTest : public testing::Test {
+        protected:
+
+        std::filesystem::path _directory;
+
+        auto SetUp() -> void override {
+            _directory = std::filesystem::temp_directory_path() / fmt::format("fox-task-queue-test-{}", std::random_device()());
+        }
+
+        auto TearDown() -> void override {
+            std::error_code error;
+            std::filesystem::remove_all(_directory, error);
+        }
+    };
+}
+
+TEST_F(TaskQueueTest, RejectsTasksOnceLaneIsFullWithoutSpillDirectory) {
+    using enum fox::dto::TaskType;
+
+    fox::TaskQueue queue(4, fox::QueueConfig{}); // Power and mode share lane 0, speed gets lane 1, 2 tasks each
+
+    EXPECT_TRUE(queue.try_push(make_task(SPEED, 1)));
+    EXPECT_TRUE(queue.try_push(make_task(SPEED, 2)));
+    EXPECT_FALSE(queue.try_push(make_task(SPEED, 3)));
+    EXPECT_TRUE(queue.try_push(make_task(POWER, 1))); // Other lanes keep their share
+    EXPECT_EQ(queue.get_spilled_count(), 0);
+
+    const std::vector<Value> expected = {{POWER, 1}, {SPEED, 1}, {SPEED, 2}};
+    EXPECT_EQ(drain(queue), expected);
+}
+
+TEST_F(TaskQueueTest, KeepsLaneOrderAcrossSpillAndRefill) {
+    using enum fox::dto::TaskType;
+
+    fox::TaskQueue queue(4, fox::QueueConfig{}, _directory);
+
+    for (kstd::u32 speed = 1; speed <= 6; ++speed) {
+        ASSERT_TRUE(queue.try_push(make_task(SPEED, speed), speed));
+    }
+
+    EXPECT_EQ(queue.get_lane_size(1), 2);
+    EXPECT_EQ(queue.get_spilled_count(), 4);
+
+    // Spilling in one lane must not hold back the lanes above it
+    ASSERT_TRUE(queue.try_push(make_task(POWER, 1)));
+    auto task = queue.try_pop();
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->type, POWER);
+
+    task = queue.try_pop();
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->get_value(), 1);
+    EXPECT_EQ(queue.get_consumed_sequence(1), 1);
+
+    // There is room in the ring again, but the new task still has to queue up behind the spilled ones
+    ASSERT_TRUE(queue.try_push(make_task(SPEED, 7), 7));
+    EXPECT_EQ(queue.get_spilled_count(), 5);
+
+    std::vector<Value> expected;
+
+    for (kstd::u32 speed = 2; speed <= 7; ++speed) {
+        expected.emplace_back(SPEED, speed);
+    }
+
+    EXPECT_EQ(drain(queue), expected);
+    EXPECT_EQ(queue.get_spilled_count(), 0);
+    EXPECT_EQ(queue.get_consumed_sequence(1), 7);
+
+    // Once the spill file is drained, pushes go straight to the ring again
+    ASSERT_TRUE(queue.try_push(make_task(SPEED, 8), 8));
+    EXPECT_EQ(queue.get_spilled_count(), 0);
+    EXPECT_EQ(queue.get_lane_size(1), 1);
+    EXPECT_EQ(drain(queue), std::vector<Value>({{SPEED, 8}}));
+}
+
+TEST_F(TaskQueueTest, DeliversSpilledConflatedValueOnce) {
+    using enum fox::dto::TaskType;
+
+    fox::QueueConfig config{};
+    config.priorities = {1, 1, 0}; // Power and speed share lane 1, 2 tasks
+    config.conflated[static_cast<kstd::usize>(SPEED)] = true;
+
+    fox::TaskQueue queue(4, config, _directory);
+
+    ASSERT_TRUE(queue.try_push(make_task(POWER, 1)));
+    ASSERT_TRUE(queue.try_push(make_task(POWER, 0)));
+    ASSERT_TRUE(queue.try_push(make_task(SPEED, 10))); // Spills a marker
+    ASSERT_TRUE(queue.try_push(make_task(SPEED, 20))); // Spills a surplus marker
+    ASSERT_TRUE(queue.try_push(make_task(POWER, 1)));
+    EXPECT_EQ(queue.get_spilled_count(), 3);
+
+    // Only the latest speed is delivered, at the position of the oldest pending update
+    const std::vector<Value> expected = {{POWER, 1}, {POWER, 0}, {SPEED, 20}, {POWER, 1}};
+    EXPECT_EQ(drain(queue), expected);
+    EXPECT_EQ(queue.get_spilled_count(), 0);
+    EXPECT_EQ(queue.get_lane_size(1), 0);
+
+    // The surplus marker must not have left the slot behind in a state which swallows the next update
+    ASSERT_TRUE(queue.try_push(make_task(SPEED, 30)));
+    ASSERT_TRUE(queue.try_push(make_task(SPEED, 40)));
+    EXPECT_EQ(queue.get_lane_size(1), 1);
+    EXPECT_EQ(drain(queue), std::vector<Value>({{SPEED, 40}}));
+}